@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CustomComponent/TeleportAnchorComponent.h"
+#include "Teleport/TeleportAnchorIndex.h"
+#include "Engine/World.h"
+
+UTeleportAnchorComponent::UTeleportAnchorComponent()
+{
+	SetMobility(EComponentMobility::Movable);
+
+	// Setup default values.
+	snapRadius = 50.0f;
+	setRotation = true;
+	anchorIndex = INDEX_NONE;
+}
+
+void UTeleportAnchorComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	// Only anchors in game worlds can be teleported to.
+	UWorld* world = GetWorld();
+	if (world && world->IsGameWorld()) FTeleportAnchorIndex::Get(world, true)->Add(this);
+}
+
+void UTeleportAnchorComponent::OnUnregister()
+{
+	// The world no longer needs an index once its last anchor is gone.
+	FTeleportAnchorIndex* index = FTeleportAnchorIndex::Get(GetWorld(), false);
+	if (index && index->Remove(this)) FTeleportAnchorIndex::Release(GetWorld());
+	Super::OnUnregister();
+}
+
+void UTeleportAnchorComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	// Move this anchor in the index, this is usually just an update in place unless it has moved into another cell.
+	if (anchorIndex != INDEX_NONE)
+	{
+		if (FTeleportAnchorIndex* index = FTeleportAnchorIndex::Get(GetWorld(), false)) index->Update(this);
+	}
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "TeleportAnchorComponent.generated.h"
+
+/* A location the teleport arc snaps to when it lands within snapRadius of it, skipping nav-mesh validation.
+ * NOTE: Anchors add themselves to their worlds FTeleportAnchorIndex when registered and keep it up to date when moved. */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class NINETOFIVE_API UTeleportAnchorComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Distance from this anchor the teleport arc has to land for it to snap here. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TeleportAnchor", meta = (ClampMin = "1.0", UIMin = "10.0", UIMax = "200.0"))
+	float snapRadius;
+
+	/* Face the player in the direction of this anchor when teleporting to it, otherwise keep the thumbstick rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TeleportAnchor")
+	bool setRotation;
+
+	/* Index of this anchor in its worlds anchor index, INDEX_NONE if it isn't in one. */
+	int anchorIndex;
+
+protected:
+
+	/* Level start. */
+	virtual void OnRegister() override;
+
+	/* Level end. */
+	virtual void OnUnregister() override;
+
+	/* Moved. */
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
+
+public:
+
+	/* Constructor. */
+	UTeleportAnchorComponent();
+};
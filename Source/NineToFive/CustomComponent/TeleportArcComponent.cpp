@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CustomComponent/TeleportArcComponent.h"
+
+UTeleportArcComponent::UTeleportArcComponent()
+{
+	// The arc is built in world space so keep this component at the world origin whatever it is attached to.
+	SetAbsolute(true, true, true);
+	SetMobility(EComponentMobility::Movable);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	CastShadow = false;
+	bUseAsyncCooking = false;
+	SetVisibility(false);
+
+	// Setup default values.
+	arcRadius = 1.0f;
+	radialSegments = 6;
+	initialPointCapacity = 64;
+	pointCapacity = 0;
+	inPlaceUpdates = 0;
+	sectionRebuilds = 0;
+}
+
+void UTeleportArcComponent::AllocateSection(int newCapacity)
+{
+	pointCapacity = newCapacity;
+	const int ringVerts = radialSegments + 1;
+	const int numVerts = pointCapacity * ringVerts;
+	vertices.SetNumZeroed(numVerts);
+	normals.SetNumZeroed(numVerts);
+	uvs.SetNumZeroed(numVerts);
+	tangents.SetNumZeroed(numVerts);
+
+	// Index buffer never changes for a given capacity so it is only built here.
+	triangles.Reset();
+	triangles.Reserve((pointCapacity - 1) * radialSegments * 6);
+	for (int i = 0; i < pointCapacity - 1; i++)
+	{
+		for (int j = 0; j < radialSegments; j++)
+		{
+			int a = i * ringVerts + j;
+			int b = a + 1;
+			int c = a + ringVerts;
+			int d = c + 1;
+			triangles.Add(a); triangles.Add(b); triangles.Add(c);
+			triangles.Add(b); triangles.Add(d); triangles.Add(c);
+		}
+	}
+}
+
+void UTeleportArcComponent::UpdateArc(const TArray<FVector>& points)
+{
+	const int numPoints = points.Num();
+	if (numPoints < 2)
+	{
+		ClearArc();
+		return;
+	}
+
+	// Only re-create the section when the arc is longer than it has ever been or the tube shape was changed.
+	bool reallocate = numPoints > pointCapacity || vertices.Num() != pointCapacity * (radialSegments + 1);
+	if (reallocate) AllocateSection(FMath::Max3(numPoints, pointCapacity, initialPointCapacity));
+
+	// Start the ring orientation from any vector perpendicular to the first direction, then transport it along the arc to avoid twisting.
+	FVector direction = (points[1] - points[0]).GetSafeNormal();
+	FVector ringNormal = FVector::CrossProduct(direction, FVector::UpVector).GetSafeNormal();
+	if (ringNormal.IsNearlyZero()) ringNormal = FVector::CrossProduct(direction, FVector::RightVector).GetSafeNormal();
+
+	const int ringVerts = radialSegments + 1;
+	for (int i = 0; i < pointCapacity; i++)
+	{
+		// Any ring past the end of the arc is collapsed onto the last point so it draws nothing.
+		const int pointIndex = FMath::Min(i, numPoints - 1);
+		const FVector& point = points[pointIndex];
+		if (i < numPoints)
+		{
+			const FVector& previous = points[FMath::Max(pointIndex - 1, 0)];
+			const FVector& next = points[FMath::Min(pointIndex + 1, numPoints - 1)];
+			FVector newDirection = (next - previous).GetSafeNormal();
+			if (!newDirection.IsNearlyZero()) direction = newDirection;
+			ringNormal = FVector::VectorPlaneProject(ringNormal, direction).GetSafeNormal();
+		}
+		const FVector ringBinormal = FVector::CrossProduct(direction, ringNormal);
+		const float radius = i < numPoints ? arcRadius : 0.0f;
+
+		for (int j = 0; j < ringVerts; j++)
+		{
+			float sinAngle, cosAngle;
+			FMath::SinCos(&sinAngle, &cosAngle, (2.0f * PI * j) / radialSegments);
+			const FVector outward = ringNormal * cosAngle + ringBinormal * sinAngle;
+			const int vert = i * ringVerts + j;
+			vertices[vert] = point + outward * radius;
+			normals[vert] = outward;
+			tangents[vert] = FProcMeshTangent(direction, false);
+			uvs[vert] = FVector2D((float)pointIndex, (float)j / radialSegments);
+		}
+	}
+
+	// Push the new positions to the existing render buffers.
+	if (!reallocate)
+	{
+		UpdateMeshSection(0, vertices, normals, uvs, colors, tangents);
+		inPlaceUpdates++;
+	}
+	else
+	{
+		CreateMeshSection(0, vertices, triangles, normals, uvs, colors, tangents, false);
+		sectionRebuilds++;
+	}
+
+	if (!IsVisible()) SetVisibility(true);
+}
+
+void UTeleportArcComponent::ClearArc()
+{
+	if (IsVisible()) SetVisibility(false);
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "ProceduralMeshComponent.h"
+#include "TeleportArcComponent.generated.h"
+
+/* Single primitive that renders the whole teleport arc as a tube.
+ * NOTE: Vertex buffers are allocated for pointCapacity arc points and updated in place, rings past the last used point
+ *       are collapsed onto it so the vertex count never changes and the scene proxy is only re-created when the arc grows. */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class NINETOFIVE_API UTeleportArcComponent : public UProceduralMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Radius of the arc tube. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TeleportArc", meta = (ClampMin = "0.1", UIMin = "0.1", UIMax = "5.0"))
+	float arcRadius;
+
+	/* Number of sides around the arc tube. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TeleportArc", meta = (ClampMin = "3", ClampMax = "16", UIMin = "3", UIMax = "16"))
+	int radialSegments;
+
+	/* Number of arc points the vertex buffers are initially allocated for. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "TeleportArc", meta = (ClampMin = "2", UIMin = "2", UIMax = "128"))
+	int initialPointCapacity;
+
+	/* Number of arc points the vertex buffers are currently allocated for. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TeleportArc|Stats")
+	int pointCapacity;
+
+	/* Number of times the arc has been updated in place. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TeleportArc|Stats")
+	int inPlaceUpdates;
+
+	/* Number of times the mesh section had to be re-created because the arc needed more points. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "TeleportArc|Stats")
+	int sectionRebuilds;
+
+private:
+
+	TArray<FVector> vertices; /* Vertex positions kept between updates to avoid re-allocating them each frame. */
+	TArray<FVector> normals;
+	TArray<FVector2D> uvs;
+	TArray<FProcMeshTangent> tangents;
+	TArray<FColor> colors; /* Always empty, the arc is coloured through its material. */
+	TArray<int32> triangles; /* Index buffer for the current capacity. */
+
+	/* Re-size the vertex buffers and rebuild the index buffer for newCapacity arc points. The section is re-created by the next update. */
+	void AllocateSection(int newCapacity);
+
+public:
+
+	/* Constructor. */
+	UTeleportArcComponent();
+
+	/* Rebuild the arc tube in place along the given world space points and show it.
+	 * @Param points, The world space locations along the arc in order from the start of the arc. */
+	void UpdateArc(const TArray<FVector>& points);
+
+	/* Hide the arc without releasing its vertex buffers. */
+	void ClearArc();
+};
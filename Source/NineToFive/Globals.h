@@ -42,6 +42,7 @@
 #define ECC_Hand ECC_GameTraceChannel1
 #define ECC_Walkable ECC_GameTraceChannel3
 #define ECC_TeleportRing ECC_GameTraceChannel4
+#define ECC_Teleport ECC_GameTraceChannel5
 
 // Development macro for With editor so it can be disabled easily. If not defined define it.
 #ifndef DEVELOPMENT
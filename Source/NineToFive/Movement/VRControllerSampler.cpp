@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRControllerSampler.h"
+
+FVRControllerSampler::FVRControllerSampler(int newCapacity)
+{
+	capacity = 2;
+	next = 0;
+	SetCapacity(newCapacity);
+}
+
+void FVRControllerSampler::SetCapacity(int newCapacity)
+{
+	capacity = FMath::Max(newCapacity, 2);
+	samples.Reset(capacity);
+	next = 0;
+}
+
+void FVRControllerSampler::Add(double time, const FVector& position)
+{
+	FSample sample;
+	sample.time = time;
+	sample.position = position;
+	if (samples.Num() < capacity) samples.Add(sample);
+	else samples[next] = sample;
+	next = (next + 1) % capacity;
+}
+
+bool FVRControllerSampler::GetVelocity(FVector& outVelocity) const
+{
+	outVelocity = FVector::ZeroVector;
+	int count = samples.Num();
+	if (count < 2) return false;
+
+	// Fit relative to the first sample so the sums stay small enough for floats.
+	const FSample& first = samples[0];
+	double sumT = 0.0, sumTT = 0.0;
+	FVector sumP = FVector::ZeroVector, sumTP = FVector::ZeroVector;
+	for (const FSample& sample : samples)
+	{
+		float t = (float)(sample.time - first.time);
+		FVector p = sample.position - first.position;
+		sumT += t;
+		sumTT += t * t;
+		sumP += p;
+		sumTP += p * t;
+	}
+
+	double denominator = count * sumTT - sumT * sumT;
+	if (denominator <= SMALL_NUMBER) return false;
+	outVelocity = (sumTP * (float)count - sumP * (float)sumT) / (float)denominator;
+	return true;
+}
+
+void FVRControllerSampler::Reset()
+{
+	samples.Reset();
+	next = 0;
+}
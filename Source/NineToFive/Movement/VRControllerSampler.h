@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+
+/* Ring of the last few timestamped tracking space positions of a controller, so the swing speed can be fitted through several frames instead of one delta.
+ * NOTE: Filled once per frame on the game thread from the controllers own pose, tracking plugins don't allow their poses to be read from other threads. */
+class NINETOFIVE_API FVRControllerSampler
+{
+private:
+
+	struct FSample
+	{
+		double time;
+		FVector position;
+	};
+
+	TArray<FSample> samples; /* Ring holding up to capacity samples, next is the oldest once it is full. */
+	int capacity;
+	int next;
+
+public:
+
+	/* Constructor.
+	 * @Param newCapacity, Most samples fitted through, at least 2. */
+	FVRControllerSampler(int newCapacity = 6);
+
+	/* Change the number of samples fitted through, forgetting any held. */
+	void SetCapacity(int newCapacity);
+
+	/* Add this frames sample, replacing the oldest once the ring is full.
+	 * @Param time, Seconds the position was tracked at.
+	 * @Param position, Tracking space position of the controller. */
+	void Add(double time, const FVector& position);
+
+	/* Fit a line through the held samples to find how fast the controller moved over them, with less jitter than one frame delta.
+	 * @Param @Output outVelocity, Tracking space velocity, zero if it couldn't be fitted.
+	 * @Return false if there weren't at least two samples far enough apart in time to fit. */
+	bool GetVelocity(FVector& outVelocity) const;
+
+	/* Forget every sample. */
+	void Reset();
+
+	/* Returns the number of samples held. */
+	int Num() const { return samples.Num(); }
+};
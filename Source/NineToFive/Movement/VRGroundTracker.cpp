@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRGroundTracker.h"
+#include "Engine/World.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/PrimitiveComponent.h"
+
+FVRGroundTracker::FVRGroundTracker()
+{
+	checkDistance = 1.0f;
+	moveTolerance = 0.1f;
+	walkableFloorZ = 0.7f;
+	floorHitHeight = 5.0f;
+	queries = 0;
+	queriesSkipped = 0;
+	channel = ECC_WorldStatic;
+	grounded = false;
+	valid = false;
+	reportedState = -1;
+	lastFeetLocation = FVector::ZeroVector;
+}
+
+bool FVRGroundTracker::SetProfile(FName profile)
+{
+	if (UCollisionProfile::GetChannelAndResponseParams(profile, channel, responseParams)) return true;
+	channel = ECC_WorldStatic;
+	responseParams = FCollisionResponseParams::DefaultResponseParam;
+	return false;
+}
+
+void FVRGroundTracker::SetFloor(const FHitResult& hit, const FVector& feetLocation)
+{
+	grounded = true;
+	valid = true;
+	lastFeetLocation = feetLocation;
+	floor = hit.Component;
+	floorTransform = floor.IsValid() ? floor->GetComponentTransform() : FTransform::Identity;
+}
+
+void FVRGroundTracker::OnHit(const FHitResult& hit, const FVector& feetLocation)
+{
+	// Anything under the feet facing up is a floor, anything else could have pushed the capsule off of one.
+	if (hit.bBlockingHit && hit.ImpactNormal.Z >= walkableFloorZ && hit.ImpactPoint.Z <= feetLocation.Z + floorHitHeight) SetFloor(hit, feetLocation);
+	else valid = false;
+}
+
+bool FVRGroundTracker::Update(UWorld* world, const FVector& feetLocation, const FCollisionQueryParams& queryParams)
+{
+	if (!world) return false;
+
+	// Only trace if the feet or the floor have moved since the state was last found.
+	bool needsQuery = !valid || FVector::DistSquared(feetLocation, lastFeetLocation) > FMath::Square(moveTolerance);
+	if (!needsQuery && grounded)
+	{
+		UPrimitiveComponent* floorComponent = floor.Get();
+		needsQuery = !floorComponent || floorComponent->GetCollisionEnabled() == ECollisionEnabled::NoCollision || !floorComponent->GetComponentTransform().Equals(floorTransform);
+	}
+
+	if (needsQuery)
+	{
+		queries++;
+		FHitResult floorCheck;
+		if (world->LineTraceSingleByChannel(floorCheck, feetLocation, feetLocation - FVector(0.0f, 0.0f, checkDistance), channel, queryParams, responseParams)) SetFloor(floorCheck, feetLocation);
+		else
+		{
+			grounded = false;
+			valid = true;
+			lastFeetLocation = feetLocation;
+			floor = nullptr;
+		}
+	}
+	else queriesSkipped++;
+
+	// Only report transitions.
+	int state = grounded ? 1 : 0;
+	if (state == reportedState) return false;
+	reportedState = state;
+	return true;
+}
+
+void FVRGroundTracker::Reset()
+{
+	valid = false;
+	reportedState = -1;
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+
+/* Declare classes used. */
+class UWorld;
+class UPrimitiveComponent;
+
+/* Keeps track of whether the player is standing on something without tracing for the floor every frame.
+ * NOTE: The floor is only traced for again once the feet have moved, the floor has moved or been removed, or the capsule has hit something
+ *       that isn't clearly a floor. Hits from the capsules own sweeps and physics that are clearly a floor are used without a trace. */
+class NINETOFIVE_API FVRGroundTracker
+{
+public:
+
+	float checkDistance; /* Distance below the feet to look for the floor. */
+	float moveTolerance; /* Distance the feet can move before the floor is traced for again. */
+	float walkableFloorZ; /* Smallest normal Z of a hit that counts as a floor. */
+	float floorHitHeight; /* Highest above the feet a hit can be and still count as the floor. */
+	int queries; /* Number of floor traces made. */
+	int queriesSkipped; /* Number of updates that didn't need a floor trace. */
+
+private:
+
+	ECollisionChannel channel; /* Channel and responses of the profile the floor is traced with, looked up once in SetProfile. */
+	FCollisionResponseParams responseParams;
+	bool grounded;
+	bool valid; /* Is the current state still valid for lastFeetLocation. */
+	int reportedState; /* State returned by the last update that changed it, -1 before the first one. */
+	FVector lastFeetLocation;
+	TWeakObjectPtr<UPrimitiveComponent> floor; /* Component being stood on and its transform when it was found. */
+	FTransform floorTransform;
+
+	/* Set the floor from a blocking hit. */
+	void SetFloor(const FHitResult& hit, const FVector& feetLocation);
+
+public:
+
+	/* Constructor. */
+	FVRGroundTracker();
+
+	/* Look up the channel and responses of the collision profile to trace for the floor with.
+	 * @Return false if the profile doesn't exist, the floor is traced on WorldStatic with default responses. */
+	bool SetProfile(FName profile);
+
+	/* Use a hit from the capsules movement sweep or physics, a floor hit sets the floor and any other hit makes the next update trace again.
+	 * @Param hit, The capsules blocking hit.
+	 * @Param feetLocation, Location of the bottom of the capsule. */
+	void OnHit(const FHitResult& hit, const FVector& feetLocation);
+
+	/* Trace for the floor again if anything has changed since the last trace.
+	 * @Param world, World to trace in.
+	 * @Param feetLocation, Location of the bottom of the capsule.
+	 * @Param queryParams, Query params including any ignored actors.
+	 * @Return true if the grounded state has changed since the last update that changed it, or on the first update. */
+	bool Update(UWorld* world, const FVector& feetLocation, const FCollisionQueryParams& queryParams);
+
+	/* Trace for the floor on the next update even if nothing has changed, and report the state on it as if it were the first. */
+	void Reset();
+
+	/* Is the player standing on something. */
+	bool IsGrounded() const { return grounded; }
+
+	/* Returns the component being stood on, null if there isn't one or it has been destroyed. */
+	UPrimitiveComponent* GetFloor() const { return floor.Get(); }
+};
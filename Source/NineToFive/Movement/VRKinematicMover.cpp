@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRKinematicMover.h"
+#include "Movement/VRLocalCollisionCache.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+/* Gap kept between the capsule and the floor so resting on it doesn't start every sweep penetrating. */
+static const float floorGap = 0.5f;
+
+int FVRFixedStep::Advance(float deltaTime)
+{
+	if (stepTime <= 0.0f) return 0;
+	accumulator += FMath::Max(deltaTime, 0.0f);
+	int steps = FMath::FloorToInt(accumulator / stepTime);
+	if (steps > maxSteps)
+	{
+		steps = maxSteps;
+		accumulator = 0.0f;
+	}
+	else accumulator -= steps * stepTime;
+	return steps;
+}
+
+FVRKinematicMover::FVRKinematicMover()
+{
+	maxStepHeight = 30.0f;
+	walkableFloorZ = 0.7f;
+	terminalVelocity = 4000.0f;
+	maxSlides = 4;
+	velocity = FVector::ZeroVector;
+	collisionCache = nullptr;
+	grounded = false;
+}
+
+void FVRKinematicMover::Move(UCapsuleComponent* capsule, const FVector& desiredVelocity, float deltaTime, float acceleration, float deceleration, float gravityZ)
+{
+	if (!capsule || deltaTime <= 0.0f) return;
+	FVector horizontal = Accelerate(desiredVelocity, deltaTime, acceleration, deceleration);
+
+	// Fall with the exact distance for constant gravity over the frame.
+	float fallDelta = 0.0f;
+	if (grounded) velocity.Z = 0.0f;
+	else
+	{
+		fallDelta = velocity.Z * deltaTime + 0.5f * gravityZ * deltaTime * deltaTime;
+		velocity.Z = FMath::Max(velocity.Z + gravityZ * deltaTime, -terminalVelocity);
+	}
+	velocity = FVector(horizontal.X, horizontal.Y, velocity.Z);
+
+	bool wasGrounded = grounded;
+	bool landed = SlideMove(capsule, horizontal * deltaTime + FVector(0.0f, 0.0f, fallDelta));
+
+	// Keep walking capsules on the floor down slopes and off small ledges, otherwise start falling.
+	FHitResult floorHit;
+	if (landed)
+	{
+		grounded = true;
+		velocity.Z = 0.0f;
+	}
+	else if (wasGrounded || velocity.Z <= 0.0f)
+	{
+		float snapDistance = wasGrounded ? maxStepHeight : floorGap * 2.0f;
+		grounded = FindFloor(capsule, snapDistance, floorHit);
+		if (grounded)
+		{
+			float drop = FMath::Max(floorHit.Distance - floorGap, 0.0f);
+			if (drop > 0.0f) capsule->MoveComponent(FVector(0.0f, 0.0f, -drop), capsule->GetComponentQuat(), false);
+			velocity.Z = 0.0f;
+		}
+	}
+	else grounded = false;
+}
+
+FVector FVRKinematicMover::Accelerate(const FVector& desiredVelocity, float deltaTime, float acceleration, float deceleration)
+{
+	// Accelerate towards the desired velocity, slowing down at the deceleration rate when stopping or turning back.
+	FVector horizontal(velocity.X, velocity.Y, 0.0f);
+	FVector target(desiredVelocity.X, desiredVelocity.Y, 0.0f);
+	float rate = (target.IsNearlyZero() || FVector::DotProduct(target, horizontal) < 0.0f) ? deceleration : acceleration;
+	FVector change = target - horizontal;
+	float maxChange = rate * deltaTime;
+	horizontal = change.SizeSquared() <= FMath::Square(maxChange) ? target : horizontal + change.GetSafeNormal() * maxChange;
+	velocity.X = horizontal.X;
+	velocity.Y = horizontal.Y;
+	return horizontal;
+}
+
+bool FVRKinematicMover::SlideMove(UCapsuleComponent* capsule, FVector delta)
+{
+	bool hitFloor = false;
+	FVector firstNormal = FVector::ZeroVector;
+	for (int i = 0; i < maxSlides && !delta.IsNearlyZero(); i++)
+	{
+		FHitResult hit;
+		MoveCapsule(capsule, delta, hit);
+		if (!hit.IsValidBlockingHit()) break;
+
+		// Floors stop the fall and the rest of the move follows their slope at the same horizontal speed, anything else is slid along.
+		if (IsWalkable(hit))
+		{
+			hitFloor = true;
+			FVector remaining = FVector(delta.X, delta.Y, 0.0f) * (1.0f - hit.Time);
+			remaining.Z = -(hit.Normal.X * remaining.X + hit.Normal.Y * remaining.Y) / FMath::Max(hit.Normal.Z, KINDA_SMALL_NUMBER);
+			delta = remaining;
+			continue;
+		}
+
+		// Walls only a step high are climbed instead.
+		FVector remaining = delta * (1.0f - hit.Time);
+		if (grounded && FMath::Abs(hit.ImpactNormal.Z) < walkableFloorZ && StepUp(capsule, FVector(remaining.X, remaining.Y, 0.0f)))
+		{
+			hitFloor = true;
+			break;
+		}
+
+		// Stop pushing into the wall, and into the crease when sliding into a second wall.
+		velocity = FVector::VectorPlaneProject(velocity, hit.Normal);
+		FVector slide = FVector::VectorPlaneProject(remaining, hit.Normal);
+		if (!firstNormal.IsZero() && FVector::DotProduct(slide, firstNormal) < 0.0f)
+		{
+			FVector crease = FVector::CrossProduct(firstNormal, hit.Normal).GetSafeNormal();
+			slide = crease * FVector::DotProduct(remaining, crease);
+		}
+		if (firstNormal.IsZero()) firstNormal = hit.Normal;
+		delta = slide;
+	}
+	return hitFloor;
+}
+
+bool FVRKinematicMover::StepUp(UCapsuleComponent* capsule, const FVector& delta)
+{
+	if (delta.IsNearlyZero()) return false;
+	FVector start = capsule->GetComponentLocation();
+	FQuat rotation = capsule->GetComponentQuat();
+
+	// Up, over and back down onto the ledge.
+	FHitResult upHit;
+	MoveCapsule(capsule, FVector(0.0f, 0.0f, maxStepHeight), upHit);
+	float stepHeight = capsule->GetComponentLocation().Z - start.Z;
+
+	FHitResult forwardHit;
+	MoveCapsule(capsule, delta, forwardHit);
+
+	FHitResult floorHit;
+	if (stepHeight > KINDA_SMALL_NUMBER && !forwardHit.bStartPenetrating && FindFloor(capsule, stepHeight + floorGap, floorHit) && floorHit.Distance > 0.0f)
+	{
+		capsule->MoveComponent(FVector(0.0f, 0.0f, -FMath::Max(floorHit.Distance - floorGap, 0.0f)), rotation, false);
+
+		// Only count it as a step if the capsule actually made it forward.
+		FVector moved = capsule->GetComponentLocation() - start;
+		if (FVector2D(moved.X, moved.Y).SizeSquared() > KINDA_SMALL_NUMBER) return true;
+	}
+
+	capsule->SetWorldLocation(start, false, nullptr, ETeleportType::None);
+	return false;
+}
+
+bool FVRKinematicMover::MoveCapsule(UCapsuleComponent* capsule, const FVector& delta, FHitResult& outHit)
+{
+	FVector start = capsule->GetComponentLocation();
+	FBox sweepBounds = FBox(start.ComponentMin(start + delta), start.ComponentMax(start + delta)).ExpandBy(capsule->GetCollisionShape().GetExtent());
+	if (!collisionCache || !collisionCache->Covers(sweepBounds)) return capsule->MoveComponent(delta, capsule->GetComponentQuat(), true, &outHit);
+
+	// Starting inside something needs the components own move to push back out of it.
+	bool hit = SweepTest(capsule, start, start + delta, outHit);
+	if (hit && outHit.bStartPenetrating) return capsule->MoveComponent(delta, capsule->GetComponentQuat(), true, &outHit);
+
+	// Stop just short of the hit so the next sweep doesn't start touching it.
+	float time = 1.0f;
+	if (hit)
+	{
+		float size = delta.Size();
+		time = size > KINDA_SMALL_NUMBER ? FMath::Clamp(outHit.Time - 0.1f / size, 0.0f, 1.0f) : 0.0f;
+	}
+	if (time > 0.0f) capsule->SetWorldLocation(start + delta * time, false, nullptr, ETeleportType::None);
+	if (hit && capsule->GetOwner()) capsule->DispatchBlockingHit(*capsule->GetOwner(), outHit);
+	return time > 0.0f;
+}
+
+bool FVRKinematicMover::SweepTest(UCapsuleComponent* capsule, const FVector& start, const FVector& end, FHitResult& outHit) const
+{
+	UWorld* world = capsule->GetWorld();
+	if (!world) return false;
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(VRKinematicSweep), false, capsule->GetOwner());
+	FCollisionResponseParams responseParams;
+	capsule->InitSweepCollisionParams(queryParams, responseParams);
+	FQuat rotation = capsule->GetComponentQuat();
+	FCollisionShape shape = capsule->GetCollisionShape();
+	FBox sweepBounds = FBox(start.ComponentMin(end), start.ComponentMax(end)).ExpandBy(shape.GetExtent());
+	if (!collisionCache || !collisionCache->Covers(sweepBounds)) return world->SweepSingleByChannel(outHit, start, end, rotation, capsule->GetCollisionObjectType(), shape, queryParams, responseParams);
+
+	// Static primitives come from the cache, only movable bodies go through the scene.
+	FHitResult staticHit;
+	bool hitStatic = collisionCache->Sweep(staticHit, start, end, rotation, shape);
+	queryParams.MobilityType = EQueryMobilityType::Dynamic;
+	bool hitDynamic = world->SweepSingleByChannel(outHit, start, end, rotation, capsule->GetCollisionObjectType(), shape, queryParams, responseParams);
+	if (hitStatic && (!hitDynamic || staticHit.Time < outHit.Time)) outHit = staticHit;
+	return hitStatic || hitDynamic;
+}
+
+bool FVRKinematicMover::FindFloor(UCapsuleComponent* capsule, float distance, FHitResult& outHit) const
+{
+	FVector start = capsule->GetComponentLocation();
+	bool found = SweepTest(capsule, start, start - FVector(0.0f, 0.0f, distance), outHit);
+	return found && !outHit.bStartPenetrating && IsWalkable(outHit);
+}
+
+void FVRKinematicMover::Reset()
+{
+	velocity = FVector::ZeroVector;
+	grounded = false;
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+/* Declare classes used. */
+class UCapsuleComponent;
+class FVRLocalCollisionCache;
+
+/* Accumulates frame time and hands it out in fixed steps so movement is the same at any frame rate. */
+struct NINETOFIVE_API FVRFixedStep
+{
+	float stepTime; /* Seconds per step. */
+	int maxSteps; /* Most steps ran in one frame, any time past this is dropped so a long frame can't cause a longer one. */
+	float accumulator; /* Seconds not yet stepped. */
+
+	FVRFixedStep()
+		: stepTime(1.0f / 90.0f), maxSteps(4), accumulator(0.0f)
+	{}
+
+	/* Add a frames time and return the number of steps to run for it. */
+	int Advance(float deltaTime);
+
+	/* Returns how far between the last step and the next the current time is, from 0 to 1. */
+	float GetAlpha() const { return stepTime > 0.0f ? FMath::Clamp(accumulator / stepTime, 0.0f, 1.0f) : 1.0f; }
+
+	/* Drop any accumulated time. */
+	void Reset() { accumulator = 0.0f; }
+};
+
+/* Moves a capsule that never simulates physics with sweeps, sliding along walls, stepping up small ledges, snapping down onto the floor and falling with gravity.
+ * NOTE: Gravity is applied analytically so the distance fallen each frame is exact for any frame time. */
+class NINETOFIVE_API FVRKinematicMover
+{
+public:
+
+	float maxStepHeight; /* Tallest ledge that can be stepped up and furthest the capsule is snapped down onto the floor while walking. */
+	float walkableFloorZ; /* Smallest normal Z of a surface that can be stood on. */
+	float terminalVelocity; /* Fastest the capsule can fall. */
+	int maxSlides; /* Most surfaces a single move can slide along. */
+	FVector velocity;
+	const FVRLocalCollisionCache* collisionCache; /* Static primitives near the capsule, swept against with a dynamic only scene query instead of a full scene sweep when set. */
+
+private:
+
+	bool grounded;
+
+	/* Sweep the capsule by delta, sliding along anything it hits and stepping up any ledges while grounded.
+	 * @Return true if a walkable floor was hit. */
+	bool SlideMove(UCapsuleComponent* capsule, FVector delta);
+
+	/* Try to move over a ledge in front of the capsule by sweeping up, along delta and back down.
+	 * @Return true if the capsule ended up on a walkable floor, otherwise it is left where it started. */
+	bool StepUp(UCapsuleComponent* capsule, const FVector& delta);
+
+	/* Sweep the capsule shape from start to end without moving it, against the collision cache and movable bodies if the cache covers the sweep.
+	 * @Return true if anything blocking was hit. */
+	bool SweepTest(UCapsuleComponent* capsule, const FVector& start, const FVector& end, FHitResult& outHit) const;
+
+	/* Sweep the capsule shape down from its location.
+	 * @Return true if a walkable floor was found within distance. */
+	bool FindFloor(UCapsuleComponent* capsule, float distance, FHitResult& outHit) const;
+
+	/* Returns true if a hit is on a surface that can be stood on. */
+	bool IsWalkable(const FHitResult& hit) const { return hit.bBlockingHit && hit.ImpactNormal.Z >= walkableFloorZ; }
+
+public:
+
+	/* Constructor. */
+	FVRKinematicMover();
+
+	/* Move the capsule for a frame.
+	 * @Param capsule, The capsule to move, it should not be simulating physics.
+	 * @Param desiredVelocity, Horizontal velocity to accelerate towards.
+	 * @Param deltaTime, Seconds to move for.
+	 * @Param acceleration, Rate the horizontal velocity speeds up at.
+	 * @Param deceleration, Rate the horizontal velocity slows down at.
+	 * @Param gravityZ, Gravity applied while off the ground. */
+	void Move(UCapsuleComponent* capsule, const FVector& desiredVelocity, float deltaTime, float acceleration, float deceleration, float gravityZ);
+
+	/* Sweep the capsule by delta, stopping at the first blocking hit.
+	 * @Param capsule, The capsule to move.
+	 * @Param delta, Distance to move.
+	 * @Param @Output outHit, The blocking hit if there was one.
+	 * @Return false if the capsule couldn't be moved. */
+	bool MoveCapsule(UCapsuleComponent* capsule, const FVector& delta, FHitResult& outHit);
+
+	/* Accelerate the horizontal velocity towards the desired velocity without moving.
+	 * @Return the new horizontal velocity. */
+	FVector Accelerate(const FVector& desiredVelocity, float deltaTime, float acceleration, float deceleration);
+
+	/* Stop moving and find the floor again on the next move. */
+	void Reset();
+
+	/* Is the capsule standing on a walkable floor. */
+	bool IsGrounded() const { return grounded; }
+};
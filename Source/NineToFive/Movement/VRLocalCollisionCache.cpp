@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRLocalCollisionCache.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "WorldCollision.h"
+
+FVRLocalCollisionCache::FVRLocalCollisionCache()
+{
+	cellSize = 200.0f;
+	radius = 400.0f;
+	rebuilds = 0;
+	cell = FIntVector::ZeroValue;
+	coveredBounds = FBox(ForceInit);
+	built = false;
+}
+
+void FVRLocalCollisionCache::Update(UPrimitiveComponent* component)
+{
+	UWorld* world = component ? component->GetWorld() : nullptr;
+	if (!world || cellSize <= 0.0f) return;
+
+	FVector location = component->GetComponentLocation();
+	FIntVector newCell(FMath::FloorToInt(location.X / cellSize), FMath::FloorToInt(location.Y / cellSize), FMath::FloorToInt(location.Z / cellSize));
+	if (built && newCell == cell) return;
+
+	// Find everything static that blocks the component within the radius of any point in the cell.
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(VRLocalCollision), false, component->GetOwner());
+	FCollisionResponseParams responseParams;
+	component->InitSweepCollisionParams(queryParams, responseParams);
+	queryParams.MobilityType = EQueryMobilityType::Static;
+	FVector center = (FVector(newCell.X, newCell.Y, newCell.Z) + FVector(0.5f)) * cellSize;
+	FVector extent(radius + cellSize * 0.5f);
+	TArray<FOverlapResult> overlaps;
+	world->OverlapMultiByChannel(overlaps, center, FQuat::Identity, component->GetCollisionObjectType(), FCollisionShape::MakeBox(extent), queryParams, responseParams);
+
+	entries.Reset();
+	for (const FOverlapResult& overlap : overlaps)
+	{
+		UPrimitiveComponent* primitive = overlap.Component.Get();
+		if (overlap.bBlockingHit && primitive) entries.Add({ primitive, primitive->Bounds.GetBox() });
+	}
+	cell = newCell;
+	coveredBounds = FBox(center - extent, center + extent);
+	built = true;
+	rebuilds++;
+}
+
+bool FVRLocalCollisionCache::Sweep(FHitResult& outHit, const FVector& start, const FVector& end, const FQuat& rotation, const FCollisionShape& shape) const
+{
+	outHit.Init(start, end);
+	FBox sweepBounds = FBox(start.ComponentMin(end), start.ComponentMax(end)).ExpandBy(shape.GetExtent());
+	bool found = false;
+	for (const FEntry& entry : entries)
+	{
+		// Only the primitives the sweep passes by are tested against.
+		UPrimitiveComponent* primitive = entry.component.Get();
+		if (!primitive || !entry.bounds.Intersect(sweepBounds) || !primitive->IsCollisionEnabled()) continue;
+
+		FHitResult hit;
+		if (primitive->SweepComponent(hit, start, end, rotation, shape) && (!found || hit.Time < outHit.Time))
+		{
+			outHit = hit;
+			outHit.bBlockingHit = true;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void FVRLocalCollisionCache::Empty()
+{
+	entries.Empty();
+	coveredBounds = FBox(ForceInit);
+	built = false;
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+
+/* Declare classes used. */
+class UPrimitiveComponent;
+
+/* Static primitives around a component that block it, so its sweeps can test them directly instead of going through the whole scenes broadphase.
+ * NOTE: Only refreshed when the component moves into a new cell, static primitives can't move so only streaming levels in or out needs it emptied. */
+class NINETOFIVE_API FVRLocalCollisionCache
+{
+public:
+
+	float cellSize; /* Size of the cells the cache is refreshed when moving between. */
+	float radius; /* Distance around the cell that primitives are cached from. */
+	int rebuilds; /* Number of times the cache has been refreshed. */
+
+private:
+
+	/* Cached primitive and its bounds. */
+	struct FEntry
+	{
+		TWeakObjectPtr<UPrimitiveComponent> component;
+		FBox bounds;
+	};
+
+	TArray<FEntry> entries;
+	FIntVector cell;
+	FBox coveredBounds; /* Area every static primitive that blocks the component was found in. */
+	bool built;
+
+public:
+
+	/* Constructor. */
+	FVRLocalCollisionCache();
+
+	/* Refresh the cache if the component has moved into a different cell since it was last refreshed.
+	 * @Param component, The component that will be swept, its channel and responses are used to find what blocks it. */
+	void Update(UPrimitiveComponent* component);
+
+	/* Is every static primitive that could block a sweep inside box in the cache. */
+	bool Covers(const FBox& box) const { return built && coveredBounds.IsInside(box); }
+
+	/* Sweep a shape against the cached primitives.
+	 * @Param @Output outHit, The nearest blocking hit.
+	 * @Return true if anything was hit. */
+	bool Sweep(FHitResult& outHit, const FVector& start, const FVector& end, const FQuat& rotation, const FCollisionShape& shape) const;
+
+	/* Empty the cache so it is refreshed on the next update. */
+	void Empty();
+
+	/* Returns the number of cached primitives. */
+	int Num() const { return entries.Num(); }
+};
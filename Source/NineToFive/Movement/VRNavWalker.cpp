@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRNavWalker.h"
+#include "NavMesh/RecastNavMesh.h"
+
+FVRNavWalker::FVRNavWalker()
+{
+	searchExtent = FVector(20.0f, 20.0f, 100.0f);
+	maxHeightOffset = 50.0f;
+	maxSlides = 3;
+	queries = 0;
+	onNavMesh = false;
+	poly = INVALID_NAVNODEREF;
+	navLocation = FVector::ZeroVector;
+	lastFeetLocation = FVector::ZeroVector;
+	heightOffset = 0.0f;
+}
+
+bool FVRNavWalker::FindNavMesh(const ANavigationData* navData, const FVector& feetLocation, FSharedConstNavQueryFilter filter)
+{
+	queries++;
+	FNavLocation found;
+	onNavMesh = navData->ProjectPoint(feetLocation, found, searchExtent, filter) && FMath::Abs(feetLocation.Z - found.Location.Z) <= maxHeightOffset;
+	if (onNavMesh)
+	{
+		poly = found.NodeRef;
+		navLocation = found.Location;
+		heightOffset = feetLocation.Z - found.Location.Z;
+		lastFeetLocation = feetLocation;
+	}
+	return onNavMesh;
+}
+
+bool FVRNavWalker::Move(const ANavigationData* navData, FVector& feetLocation, const FVector& delta, FSharedConstNavQueryFilter filter)
+{
+	if (!navData || !navData->IsA<ARecastNavMesh>())
+	{
+		onNavMesh = false;
+		return false;
+	}
+	if (!filter.IsValid()) filter = navData->GetDefaultQueryFilter();
+
+	// Find the nav-mesh again if the feet have been moved by anything else.
+	if (!onNavMesh || !feetLocation.Equals(lastFeetLocation, 0.1f))
+	{
+		if (!FindNavMesh(navData, feetLocation, filter)) return false;
+	}
+
+	// Raycast along the nav-mesh, sliding along any edge that is hit.
+	FVector start = navLocation;
+	FVector remaining(delta.X, delta.Y, 0.0f);
+	for (int i = 0; i < maxSlides && !remaining.IsNearlyZero(); i++)
+	{
+		queries++;
+		FVector hitLocation;
+		FRaycastResult result;
+		bool hit = ARecastNavMesh::NavMeshRaycast(navData, poly, start, start + remaining, hitLocation, filter, nullptr, result);
+		if (result.CorridorPolysCount > 0) poly = result.GetLastNodeRef();
+		if (!hit)
+		{
+			start = hitLocation;
+			break;
+		}
+
+		// Keep slightly inside the edge so the next raycast doesn't start on it.
+		FVector normal(result.HitNormal.X, result.HitNormal.Y, 0.0f);
+		normal = normal.GetSafeNormal();
+		if (FVector::DotProduct(normal, remaining) > 0.0f) normal = -normal;
+		remaining = FVector::VectorPlaneProject(remaining * (1.0f - result.HitTime), normal);
+		start = hitLocation + normal * 0.5f;
+	}
+
+	// Raycasts don't follow the height of the nav-mesh so find it at the end.
+	queries++;
+	FNavLocation found;
+	if (!navData->ProjectPoint(start, found, FVector(1.0f, 1.0f, searchExtent.Z), filter))
+	{
+		onNavMesh = false;
+		return false;
+	}
+	poly = found.NodeRef;
+	navLocation = found.Location;
+	feetLocation = navLocation + FVector(0.0f, 0.0f, heightOffset);
+	lastFeetLocation = feetLocation;
+	return true;
+}
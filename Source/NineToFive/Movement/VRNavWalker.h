@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavigationData.h"
+
+/* Moves the feet along the nav-mesh instead of sweeping a capsule through the world, sliding along the nav-mesh edges like walls.
+ * NOTE: Only what the nav-mesh knows about is collided with, so anything movable has to be a nav modifier or obstacle to block the player.
+ *       The height of the feet above the nav-mesh when it was found is kept while walking on it, as the nav-mesh isn't flush with the floor. */
+class NINETOFIVE_API FVRNavWalker
+{
+public:
+
+	FVector searchExtent; /* Extent searched around the feet for the nav-mesh. */
+	float maxHeightOffset; /* Furthest the feet can be above or below the nav-mesh when it is found, any further and they aren't on it. */
+	int maxSlides; /* Most nav-mesh edges a single move can slide along. */
+	int queries; /* Number of nav-mesh raycasts and projections made. */
+
+private:
+
+	bool onNavMesh;
+	NavNodeRef poly; /* Nav-mesh polygon the feet are on. */
+	FVector navLocation; /* Location of the feet on the nav-mesh. */
+	FVector lastFeetLocation; /* Feet location given out by the last move, anything else means something else has moved them. */
+	float heightOffset; /* Height of the feet above the nav-mesh. */
+
+	/* Project the feet onto the nav-mesh.
+	 * @Return true if the nav-mesh was found. */
+	bool FindNavMesh(const ANavigationData* navData, const FVector& feetLocation, FSharedConstNavQueryFilter filter);
+
+public:
+
+	/* Constructor. */
+	FVRNavWalker();
+
+	/* Move the feet along the nav-mesh, finding it again first if they have been moved since the last move.
+	 * @Param navData, Nav-mesh to walk on, must be a recast nav-mesh.
+	 * @Param @Output feetLocation, Location of the bottom of the capsule, set to the new location on success.
+	 * @Param delta, Horizontal distance to move.
+	 * @Param filter, Query filter to use, the nav datas default filter if null.
+	 * @Return false if there is no nav-mesh under the feet, they aren't moved. */
+	bool Move(const ANavigationData* navData, FVector& feetLocation, const FVector& delta, FSharedConstNavQueryFilter filter);
+
+	/* Find the nav-mesh again on the next move. */
+	void Reset() { onNavMesh = false; }
+
+	/* Were the feet on the nav-mesh after the last move. */
+	bool IsOnNavMesh() const { return onNavMesh; }
+};
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Movement/VRVignetteDriver.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+FVRVignetteDriver::FVRVignetteDriver()
+{
+	writeTolerance = 0.002f;
+	writes = 0;
+	parameterName = NAME_None;
+	parameterIndex = INDEX_NONE;
+	opacity = 1.0f;
+	writtenOpacity = 1.0f;
+}
+
+void FVRVignetteDriver::SetMaterial(UMaterialInstanceDynamic* newMaterial, FName parameter, float initialOpacity)
+{
+	material = newMaterial;
+	parameterName = parameter;
+	parameterIndex = INDEX_NONE;
+	opacity = initialOpacity;
+	writtenOpacity = initialOpacity;
+	if (newMaterial && !newMaterial->InitializeScalarParameterAndGetIndex(parameter, initialOpacity, parameterIndex)) parameterIndex = INDEX_NONE;
+	writes++;
+}
+
+void FVRVignetteDriver::Update(float target, float deltaTime, float interpSpeed)
+{
+	opacity = FMath::FInterpTo(opacity, target, deltaTime, interpSpeed);
+
+	// Only write changes big enough to see, or the last step onto the target.
+	if (FMath::Abs(opacity - writtenOpacity) >= writeTolerance || (opacity == target && writtenOpacity != target)) Write();
+}
+
+void FVRVignetteDriver::Write()
+{
+	UMaterialInstanceDynamic* dynamicMaterial = material.Get();
+	if (!dynamicMaterial) return;
+
+	// Fall back to the name if the index has gone stale, and look the index up again.
+	if (parameterIndex == INDEX_NONE || !dynamicMaterial->SetScalarParameterByIndex(parameterIndex, opacity))
+	{
+		if (!dynamicMaterial->InitializeScalarParameterAndGetIndex(parameterName, opacity, parameterIndex)) parameterIndex = INDEX_NONE;
+	}
+	writtenOpacity = opacity;
+	writes++;
+}
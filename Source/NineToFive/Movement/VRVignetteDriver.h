@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+
+/* Declare classes used. */
+class UMaterialInstanceDynamic;
+
+/* Fades a vignette materials opacity parameter towards a target once per update, writing it through the parameters index and only when it has changed. */
+class NINETOFIVE_API FVRVignetteDriver
+{
+public:
+
+	float writeTolerance; /* Smallest change in opacity that is written to the material. */
+	int writes; /* Number of times the parameter has been written. */
+
+private:
+
+	TWeakObjectPtr<UMaterialInstanceDynamic> material;
+	FName parameterName;
+	int32 parameterIndex; /* Index of the parameter in the material, found once when the material is set. */
+	float opacity;
+	float writtenOpacity;
+
+	/* Write the opacity to the material. */
+	void Write();
+
+public:
+
+	/* Constructor. */
+	FVRVignetteDriver();
+
+	/* Set the material to drive and write its starting opacity.
+	 * @Param newMaterial, The vignettes dynamic material.
+	 * @Param parameter, Name of the scalar opacity parameter.
+	 * @Param initialOpacity, Opacity to start at, 1 is invisible. */
+	void SetMaterial(UMaterialInstanceDynamic* newMaterial, FName parameter, float initialOpacity);
+
+	/* Interpolate the opacity towards target and write it if it has changed.
+	 * @Param target, Opacity to fade towards.
+	 * @Param deltaTime, Seconds since the last update.
+	 * @Param interpSpeed, Speed to interpolate at. */
+	void Update(float target, float deltaTime, float interpSpeed);
+
+	/* Returns the current opacity. */
+	float GetOpacity() const { return opacity; }
+};
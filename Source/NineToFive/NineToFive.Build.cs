@@ -9,9 +9,9 @@ public class NineToFive : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" , "HeadMountedDisplay", "NavigationSystem", "AIModule",
-            "UMG", "Slate", "SlateCore", "RenderCore", "Paper2D", "PhysX" , "APEX"});
+            "UMG", "Slate", "SlateCore", "RenderCore", "Paper2D", "PhysX" , "APEX", "ProceduralMeshComponent"});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore", "RenderCore" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore", "RenderCore", "Navmesh" });
 
 		// Uncomment if you are using online features
 		// PrivateDependencyModuleNames.Add("OnlineSubsystem");
@@ -2,6 +2,7 @@
 
 #include "Player/VRHand.h"
 #include "Player/VRPawn.h"
+#include "Player/VRMovement.h"
 #include "Player/HandsAnimInstance.h"
 #include "XRMotionControllerBase.h"
 #include "Haptics/HapticFeedbackEffect_Base.h"
@@ -84,6 +85,7 @@ AVRHand::AVRHand()
 	handEnum = EControllerHand::Left;
 	grabbing = false;
 	gripping = false;
+	heldComponent = nullptr;
 	foundController = false;
 	active = true;
 	collisionEnabled = false;
@@ -170,6 +172,10 @@ void AVRHand::Grab()
 	// Grab pressed.
 	grabbing = true;
 
+	// Stop the teleport arc landing on whatever is picked up.
+	heldComponent = FindGrabbedComponent();
+	if (heldComponent && player && player->vrMovement) player->vrMovement->SetIgnoredByTeleport(heldComponent, true);
+
 #if WITH_EDITOR
 	// If in dev-mode ensure the trigger is 1.0f when grabbed.
 	if (devModeEnabled) trigger = 1.0f;
@@ -185,6 +191,34 @@ void AVRHand::Drop()
 
 	// Grab released.
 	grabbing = false;
+
+	// Let the teleport arc hit the dropped component again, unless the other hand is still holding it.
+	if (heldComponent && player && player->vrMovement && (!otherHand || otherHand->heldComponent != heldComponent)) player->vrMovement->SetIgnoredByTeleport(heldComponent, false);
+	heldComponent = nullptr;
+}
+
+UPrimitiveComponent* AVRHand::FindGrabbedComponent() const
+{
+	if (!handSkel) return nullptr;
+
+	TArray<UPrimitiveComponent*> overlaps;
+	handSkel->GetOverlappingComponents(overlaps);
+	UPrimitiveComponent* closest = nullptr;
+	float closestDistance = MAX_flt;
+	FVector handLocation = handSkel->GetComponentLocation();
+	for (UPrimitiveComponent* overlap : overlaps)
+	{
+		// Only props that can be moved are picked up, the player and its hands never are.
+		AActor* owner = overlap ? overlap->GetOwner() : nullptr;
+		if (!overlap || overlap->Mobility != EComponentMobility::Movable || owner == this || owner == otherHand || owner == player) continue;
+		float distance = FVector::DistSquared(overlap->GetComponentLocation(), handLocation);
+		if (distance < closestDistance)
+		{
+			closest = overlap;
+			closestDistance = distance;
+		}
+	}
+	return closest;
 }
 
 void AVRHand::Grip(bool pressed)
@@ -23,6 +23,7 @@ class UHapticFeedbackEffect_Base;
 class UWidgetInteractionComponent;
 class USphereComponent;
 class UWidgetComponent;
+class UPrimitiveComponent;
 
 /* NOTE: Just flipping a mesh on an axis to create a left and right hand from the said mesh will break its physics asset in version UE4.21.2...
  * NOTE: HandSkel collision used for interacting with grabbable etc. Constrained components must use physicsCollider to prevent constraint breakage. */
@@ -81,6 +82,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Hand|CurrentValues")
 	bool grabbing;
 
+	/* Component picked up by the last grab, the teleport arc passes through it until it is dropped. */
+	UPROPERTY(BlueprintReadOnly, Category = "Hand|CurrentValues")
+	UPrimitiveComponent* heldComponent;
+
 	/* Is the player gripping? */
 	UPROPERTY(BlueprintReadOnly, Category = "Hand|CurrentValues")
 	bool gripping;
@@ -140,6 +145,9 @@ private:
 	/* Update the hand animation variables. */
 	void UpdateAnimationInstance();
 
+	/* Returns the closest movable component the hand skeleton overlaps that isn't part of the player, null if there isn't one. */
+	UPrimitiveComponent* FindGrabbedComponent() const;
+
 public:
 
 	/* Constructor */
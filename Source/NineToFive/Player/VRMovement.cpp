@@ -10,7 +10,8 @@
 #include "Player/VRHand.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Components/SplineMeshComponent.h"
+#include "CustomComponent/TeleportArcComponent.h"
+#include "Teleport/TeleportAnchorIndex.h"
 #include "Camera/CameraComponent.h"
 #include "NavigationSystem.h"
 #include "NavigationData.h"
@@ -21,12 +22,48 @@
 #include "TimerManager.h"
 #include "Components/PrimitiveComponent.h"
 #include "Materials/MaterialInstanceDynamic.h" 
+#include "Components/MeshComponent.h"
 #include "PhysicsEngine/PhysicsHandleComponent.h"
 #include "DrawDebugHelpers.h"
 #include "NavigationQueryFilter.h"
+#include "Teleport/TeleportArcSolver.h"
+#include "EngineUtils.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Camera/PlayerCameraManager.h"
+#include "UObject/UObjectGlobals.h"
 
 DEFINE_LOG_CATEGORY(LogVRMovement);
 
+DECLARE_CYCLE_STAT(TEXT("Teleport Arc Predict"), STAT_TeleportArcPredict, STATGROUP_VRMovement);
+
+#if !UE_BUILD_SHIPPING
+/* Console command to compare the analytic teleport arc against the blueprint projectile path prediction. */
+static FAutoConsoleCommandWithWorldAndArgs BenchmarkTeleportArcCommand(
+	TEXT("VRMovement.BenchmarkTeleportArc"),
+	TEXT("Times each teleport arc solver from each movement actor in the world and compares their landings. Usage: VRMovement.BenchmarkTeleportArc [iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+	{
+		int iterations = args.Num() > 0 ? FMath::Max(FCString::Atoi(*args[0]), 1) : 1000;
+		for (TActorIterator<AVRMovement> it(world); it; ++it)
+		{
+			it->BenchmarkTeleportArc(iterations);
+		}
+	}));
+
+/* Console command to bake the teleport grids of the visible levels. */
+static FAutoConsoleCommandWithWorldAndArgs BakeTeleportGridsCommand(
+	TEXT("VRMovement.BakeTeleportGrids"),
+	TEXT("Bakes the teleport grid of each visible level from the first movement actor in the world. Usage: VRMovement.BakeTeleportGrids [cellSize]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& args, UWorld* world)
+	{
+		TActorIterator<AVRMovement> it(world);
+		if (it) it->BakeTeleportGrids(args.Num() > 0 ? FCString::Atof(*args[0]) : 0.0f);
+		else UE_LOG(LogVRMovement, Warning, TEXT("VRMovement.BakeTeleportGrids: No movement actor found, run the bake in PIE."));
+	}));
+#endif
+
 AVRMovement::AVRMovement()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -43,10 +80,15 @@ AVRMovement::AVRMovement()
 	teleportSpline->SetDefaultUpVector(FVector(0.0f, 0.0f, 1.0f), ESplineCoordinateSpace::World);
 	teleportSpline->SetupAttachment(scene);
 
+	// Single mesh for the whole teleport arc.
+	teleportArc = CreateDefaultSubobject<UTeleportArcComponent>(TEXT("TeleportArc"));
+	teleportArc->SetupAttachment(scene);
+
 	// Setup teleporting meshes and spline.
 	teleportRing = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("TeleportRing"));
 	teleportRing->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 	teleportRing->SetCollisionObjectType(ECollisionChannel::ECC_GameTraceChannel4);
+	teleportRing->SetCollisionResponseToChannel(ECC_Teleport, ECR_Ignore);
 	teleportRing->SetVisibility(false);
 	teleportRing->SetupAttachment(scene);
 
@@ -65,6 +107,9 @@ AVRMovement::AVRMovement()
 	// Setup default values.
 	invalidTeleportColor = FLinearColor::Red;
 	validTeleportColor = FLinearColor::Green;
+	validTeleportMaterial = nullptr;
+	invalidTeleportMaterial = nullptr;
+	teleportMaterialState = -1;
 	firstMove = true;
 	canMove = true;
 	lastTeleportValid = false;
@@ -83,7 +128,6 @@ AVRMovement::AVRMovement()
 	cameraMoveDirection = true;
 	vignetteDuringMovement = true;
 	canApplyVignette = true;
-	lastVignetteOpacity = 1.0f;
 	minVignetteSpeed = 0.2f;
 	vignetteTransitionSpeed = 5.0f;
 	devHandOffset = FVector(70.0f, 25.0f, 8.0f);
@@ -92,8 +136,113 @@ AVRMovement::AVRMovement()
 	minMovementOffsetRadius = 5.0f;
 	maxMovementOffsetRadius = 40.0f;
 	swingingArmsSpeed = 8.0f;
+	useControllerSampler = true;
+	controllerSampleFrames = 6;
+	swingingArmsFullSpeed = 1800.0f;
+	swingingArmsVelocity = FVector::ZeroVector;
 	inAir = false;
 	requiresNavMesh = true;
+	analyticTeleportArc = true;
+	teleportTraceMode = EVRTeleportTraceMode::Synchronous;
+	teleportTraceChannel = ECC_Teleport;
+	asyncFloorError = 0.0f;
+	hasAsyncFloorError = false;
+	incrementalTeleportArc = true;
+	teleportArcRetraceTolerance = 1.0f;
+	teleportArcRefreshFrames = 10;
+	teleportTracesSaved = 0;
+	teleportArcUpdatesSkipped = 0;
+	teleportArcLanded = false;
+	useTeleportNavCache = true;
+	teleportNavCacheHits = 0;
+	teleportNavCacheMisses = 0;
+	useTeleportGrid = true;
+	teleportGridCellSize = 25.0f;
+	teleportGridHits = 0;
+	teleportGridFallbacks = 0;
+	teleportArcSimFrequency = 30.0f;
+	teleportArcMaxSimTime = 2.0f;
+	teleportArcTraceCount = 0;
+	adaptiveTeleportArc = true;
+	teleportArcTraceError = 2.0f;
+	teleportArcPixelError = 1.0f;
+	teleportArcPixelsPerDegree = 15.0f;
+	teleportArcMaxSegments = 128;
+	teleportArcTraceSegments = 0;
+	teleportArcVisualSegments = 0;
+	teleportArcEndTime = -1.0f;
+	refinedTeleportArc = false;
+	useTeleportAnchors = true;
+	progressiveTeleportNavSearch = true;
+	teleportMinSearchDistance = 10.0f;
+	debugTeleportNavPolys = false;
+	teleportNavPolysTested = 0;
+	teleportAnchorSnaps = 0;
+	teleportAnchorSnapped = false;
+	teleportAnchorSetsRotation = false;
+	teleportArcCoarseSegments = 8;
+	teleportArcRefineSteps = 6;
+	teleportArcClearanceRadius = 2.0f;
+	teleportAimHand = nullptr;
+	teleportAimLanded = false;
+	teleportAimValid = false;
+	teleportAimEvaluated = false;
+	teleportAimReused = false;
+	teleportAimNavData = nullptr;
+	teleportAimPolysTested = 0;
+	teleportAimArcTraceCount = 0;
+	teleportAimArcTraceSegments = 0;
+	teleportAimOccupancySkipped = 0;
+	teleportAimTracesSaved = 0;
+	prewarmTeleportDestination = true;
+	teleportPrewarmFrames = 5;
+	teleportPrewarmTolerance = 50.0f;
+	teleportPrewarmRadius = 1000.0f;
+	teleportPrewarmStableFrames = 0;
+	teleportPrewarmCandidate = FVector::ZeroVector;
+	postTeleportSampleFrames = 10;
+	postTeleportFrameTime = 0.0f;
+	postTeleportFrameTimeWarm = 0.0f;
+	postTeleportFrameTimeCold = 0.0f;
+	postTeleportFramesLeft = 0;
+	postTeleportWarm = false;
+	postTeleportWarmCount = 0;
+	postTeleportColdCount = 0;
+	kinematicCapsule = true;
+	useLocalCollisionCache = true;
+	localCollisionRadius = 400.0f;
+	localCollisionCellSize = 200.0f;
+	localCollisionRebuilds = 0;
+	localCollisionPrimitives = 0;
+	navMeshWalking = false;
+	navWalkingQueries = 0;
+	fixedStepLocomotion = true;
+	locomotionStepRate = 90.0f;
+	maxLocomotionSteps = 4;
+	locomotionPreviousLocation = locomotionLocation = locomotionRenderOffset = locomotionSceneLocation = locomotionRenderSceneLocation = FVector::ZeroVector;
+	locomotionStateValid = false;
+	maxStepHeight = 30.0f;
+	groundTraces = 0;
+	groundTracesSkipped = 0;
+	useTeleportOccupancy = true;
+	teleportOccupancyVoxelSize = 50.0f;
+	teleportOccupancyExtent = FVector(3000.0f, 3000.0f, 1000.0f);
+	teleportOccupancyBuildBudget = 1.0f;
+	teleportOccupancyBuildTime = 0.0f;
+	teleportOccupancySkipped = 0;
+	teleportOccupancyCenter = FVector::ZeroVector;
+	teleportOccupancyDirty = false;
+	teleportOccupancyPendingCenter = FVector::ZeroVector;
+	teleportOccupancyPendingTime = 0.0;
+	teleportOccupancyPendingTests = 0;
+	useBlackoutQueue = true;
+	blackoutWorkBudget = 8.0f;
+	blackoutFadeThreshold = 0.95f;
+	blackoutPurgeGarbage = true;
+	blackoutProcessLoading = true;
+	blackoutWorkTime = 0.0f;
+	blackoutJobsRun = 0;
+	blackoutDrained = false;
 
 #if WITH_EDITOR
 	leftFrozen = rightFrozen = false;
@@ -103,6 +252,15 @@ AVRMovement::AVRMovement()
 
 void AVRMovement::Tick(float DeltaTime)
 {
+	// Time the frames straight after a teleport, leaving out any frame blackout jobs were ran in as it couldn't be seen.
+	if (postTeleportFramesLeft > 0 && !blackoutDrained) UpdatePostTeleportStats(DeltaTime);
+
+	// Use the frames the camera is faded out for to run any queued work.
+	UpdateBlackout();
+
+	// Spread building the teleport occupancy grid over several frames.
+	UpdateTeleportOccupancy();
+
 	//  Check if the capsule is currently in the air and if it is enable physics, otherwise disable physics.
 	if (player)
 	{
@@ -117,23 +275,37 @@ void AVRMovement::Tick(float DeltaTime)
 			case EVRMovementMode::SpeedRamp: 
 			case EVRMovementMode::Joystick:  
 			case EVRMovementMode::SwingingArms:
-			{
-				FHitResult floorCheck;
-				FCollisionQueryParams floorTraceParams;
-				floorTraceParams.AddIgnoredActor(this);
-				floorTraceParams.AddIgnoredActor(player);
-				FVector feetLocation = player->scene->GetComponentLocation();
-				GetWorld()->LineTraceSingleByProfile(floorCheck, feetLocation, feetLocation - FVector(0.0f, 0.0f, 1.0f), "PlayerCapsule", floorTraceParams);
-				// If the floor was not found enable physics.
-				if (floorCheck.bBlockingHit)
-				{
-					if (player->movementCapsule->IsSimulatingPhysics()) EnableCapsule(false);
-				}
-				else if (!player->movementCapsule->IsSimulatingPhysics()) EnableCapsule(true);
-			}
+				if (kinematicCapsule) UpdateKinematicMovement(DeltaTime);
+				else UpdateGroundState();
 			break;
 		}
+
+		// Fade the vignette once per frame.
+		UpdateVignette(DeltaTime);
+	}
+}
+
+void AVRMovement::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Make sure the teleport aim task is no longer using this actor.
+	WaitForTeleportAim();
+
+	// Remove the jobs bound to this actor from the blackout queue.
+	if (FTeleportBlackoutQueue* blackoutQueue = FTeleportBlackoutQueue::Get(GetWorld(), false))
+	{
+		for (int32 handle : blackoutJobs)
+		{
+			blackoutQueue->Remove(handle);
+		}
 	}
+	blackoutJobs.Reset();
+
+	FWorldDelegates::LevelAddedToWorld.Remove(levelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(levelRemovedHandle);
+	levelAddedHandle.Reset();
+	levelRemovedHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
@@ -145,6 +317,13 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 		playerController = Cast<APlayerController>(player->Controller);
 	}
 
+	// Teleport traces share one set of query params rather than building an ignore list every frame.
+	SetupTeleportQuery();
+	groundQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(VRGroundCheck), false);
+	groundQueryParams.AddIgnoredActor(this);
+	groundQueryParams.AddIgnoredActor(player);
+	SetupBlackoutJobs();
+
 	// Ensure this player is set to the navAgent player setup in the project settings...
 	UNavigationSystemV1* navSystem = Cast<UNavigationSystemV1>(GetWorld()->GetNavigationSystem());
 	TArray<FNavDataConfig> navProps = navSystem->GetSupportedAgents();
@@ -161,6 +340,16 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 	// Movement needs to be setup twice in the case of developer mode.
 	EVRMovementMode toSetUp = currentMovementMode;
 	if (dev) toSetUp = EVRMovementMode::Teleport;
+
+	// Start swinging arms with no controller history.
+	controllerSampler.SetCapacity(controllerSampleFrames);
+
+	// The kinematic mover replaces the floating movement and physics, Lean doesn't fall so it keeps the floating movement like every other mode.
+	bool kinematic = kinematicCapsule && (toSetUp == EVRMovementMode::SpeedRamp || toSetUp == EVRMovementMode::Joystick || toSetUp == EVRMovementMode::SwingingArms);
+	player->floatingMovement->SetComponentTickEnabled(!kinematic);
+
+	// Drop any fixed step offset the walking modes left on the room.
+	RemoveLocomotionRenderOffset();
 	
 	// Update the current movement variables.
 	switch (toSetUp)
@@ -181,9 +370,27 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 #endif
 		case EVRMovementMode::Teleport:
 		{
+			// Drop cached nav projections for any part of the nav-mesh that gets rebuilt.
+			teleportNavCache.Empty();
+			navSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &AVRMovement::OnNavigationRebuilt);
+
+			// Teleport grids are mapped in again the first time each level is aimed at.
+			teleportGrids.Empty();
+
+			// Build the occupancy grid over the next few frames and again whenever levels are streamed in or out.
+			teleportOccupancyDirty = true;
+			if (!levelAddedHandle.IsValid()) levelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &AVRMovement::OnLevelsChanged);
+			if (!levelRemovedHandle.IsValid()) levelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &AVRMovement::OnLevelsChanged);
+
 			// Initialise teleport width as the ring mesh width. Box extent is half the size of the box that fits the component.
 			teleportWidth = teleportRing->Bounds.BoxExtent.X;
 
+			// Use the old spline mesh material for the arc if one hasn't been set on the arc itself.
+			if (!teleportArc->GetMaterial(0) && teleportSplineMesh) teleportArc->SetMaterial(0, teleportSplineMesh->GetMaterial(0));
+
+			// Create the valid and invalid materials once so changing state only swaps them.
+			SetupTeleportMaterials();
+
 			// Disable capsule collision if in teleport mode.
 			player->movementCapsule->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 		}	
@@ -200,6 +407,26 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 			player->movementCapsule->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 			player->movementCapsule->SetCollisionProfileName("PlayerCapsule");
 
+			if (kinematic)
+			{
+				if (player->movementCapsule->IsSimulatingPhysics()) EnableCapsule(false);
+				kinematicMover.Reset();
+				locomotionStep.Reset();
+				navWalker.Reset();
+				localCollision.Empty();
+
+				// The local collision cache has to be refreshed whenever levels are streamed in or out.
+				if (!levelAddedHandle.IsValid()) levelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &AVRMovement::OnLevelsChanged);
+				if (!levelRemovedHandle.IsValid()) levelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &AVRMovement::OnLevelsChanged);
+				locomotionStateValid = false;
+			}
+
+			// Find the floor with the capsules own profile, looked up once here instead of on every trace, and use the capsules hits to tell when it needs finding again.
+			groundTracker.SetProfile("PlayerCapsule");
+			groundTracker.Reset();
+			player->movementCapsule->SetNotifyRigidBodyCollision(true);
+			player->movementCapsule->OnComponentHit.AddUniqueDynamic(this, &AVRMovement::OnCapsuleHit);
+
 			// Set speed of floating movement component.
 			player->floatingMovement->MaxSpeed = walkingSpeed;
 
@@ -211,7 +438,7 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 					player->vignette->SetActive(true);
 					player->vignette->SetVisibility(true);
 					vignetteMAT = player->vignette->CreateDynamicMaterialInstance(0, vingetteMATInstance);
-					vignetteMAT->SetScalarParameterValue("opacity", 1.0f);
+					vignetteDriver.SetMaterial(vignetteMAT, "opacity", 1.0f);
 				}
 				else UE_LOG(LogVRMovement, Warning, TEXT("Null refference for the vignette material instance in the vr movement class..."));
 			}
@@ -220,6 +447,132 @@ void AVRMovement::SetupMovement(AVRPawn* playerPawn, bool dev)
 	}
 }
 
+void AVRMovement::OnCapsuleHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	groundTracker.OnHit(Hit, player->scene->GetComponentLocation());
+}
+
+void AVRMovement::UpdateGroundState()
+{
+	if (groundTracker.Update(GetWorld(), player->scene->GetComponentLocation(), groundQueryParams))
+	{
+		// Fall with physics while nothing is under the feet.
+		bool grounded = groundTracker.IsGrounded();
+		if (grounded == player->movementCapsule->IsSimulatingPhysics()) EnableCapsule(!grounded);
+		onGroundStateChanged.Broadcast(grounded);
+	}
+	groundTraces = groundTracker.queries;
+	groundTracesSkipped = groundTracker.queriesSkipped;
+}
+
+void AVRMovement::UpdateKinematicMovement(float DeltaTime)
+{
+	// Use the input and speeds given to the floating movement, which isn't ticking while the kinematic mover is used.
+	UFloatingPawnMovement* floatingMovement = player->floatingMovement;
+	UCapsuleComponent* capsule = player->movementCapsule;
+	FVector desiredVelocity = player->ConsumeMovementInputVector().GetClampedToMaxSize(1.0f) * floatingMovement->MaxSpeed;
+	bool wasGrounded = kinematicMover.IsGrounded() || navWalker.IsOnNavMesh();
+	kinematicMover.maxStepHeight = maxStepHeight;
+
+	// Refresh the static primitives around the capsule when it moves into a new cell.
+	if (useLocalCollisionCache)
+	{
+		localCollision.radius = localCollisionRadius;
+		localCollision.cellSize = localCollisionCellSize;
+		localCollision.Update(capsule);
+		localCollisionRebuilds = localCollision.rebuilds;
+		localCollisionPrimitives = localCollision.Num();
+	}
+	kinematicMover.collisionCache = useLocalCollisionCache ? &localCollision : nullptr;
+
+	// Find the nav-mesh for the players agent once per frame.
+	const ANavigationData* navData = nullptr;
+	if (navMeshWalking)
+	{
+		UNavigationSystemV1* navSystem = Cast<UNavigationSystemV1>(GetWorld()->GetNavigationSystem());
+		if (navSystem) navData = navSystem->GetNavDataForProps(floatingMovement->GetNavAgentPropertiesRef());
+	}
+
+	if (!fixedStepLocomotion)
+	{
+		RemoveLocomotionRenderOffset();
+		StepLocomotion(desiredVelocity, DeltaTime, navData);
+	}
+	else
+	{
+		// Carry anything else that has moved the capsule since last frame, like teleporting or re-centering, over to the stepped locations.
+		FVector currentLocation = capsule->GetComponentLocation();
+		if (!locomotionStateValid)
+		{
+			locomotionPreviousLocation = locomotionLocation = currentLocation;
+			locomotionStateValid = true;
+		}
+		else if (!currentLocation.Equals(locomotionLocation, 0.01f))
+		{
+			FVector shift = currentLocation - locomotionLocation;
+			locomotionPreviousLocation += shift;
+			locomotionLocation += shift;
+		}
+
+		locomotionStep.stepTime = 1.0f / FMath::Max(locomotionStepRate, 1.0f);
+		locomotionStep.maxSteps = maxLocomotionSteps;
+		int steps = locomotionStep.Advance(DeltaTime);
+		for (int i = 0; i < steps; i++)
+		{
+			locomotionPreviousLocation = capsule->GetComponentLocation();
+			StepLocomotion(desiredVelocity, locomotionStep.stepTime, navData);
+		}
+		locomotionLocation = capsule->GetComponentLocation();
+
+		// Anything else that has placed the room since the offset was written, like teleporting or re-centering, gives it a new location to offset from.
+		USceneComponent* scene = player->scene;
+		if (locomotionRenderOffset.IsZero() || !scene->RelativeLocation.Equals(locomotionRenderSceneLocation, 0.01f)) locomotionSceneLocation = scene->RelativeLocation;
+
+		// Show the room part way between the last two steps with one write of its relative location, the capsule and its collision stay where the last step left them.
+		float alpha = locomotionStep.GetAlpha();
+		FVector renderOffset = alpha < 1.0f - KINDA_SMALL_NUMBER ? FMath::Lerp(locomotionPreviousLocation, locomotionLocation, alpha) - locomotionLocation : FVector::ZeroVector;
+		if (renderOffset.IsNearlyZero()) renderOffset = FVector::ZeroVector;
+		FVector sceneLocation = locomotionSceneLocation + capsule->GetComponentTransform().InverseTransformVectorNoScale(renderOffset);
+		if (!scene->RelativeLocation.Equals(sceneLocation)) scene->SetRelativeLocation(sceneLocation);
+		locomotionRenderOffset = renderOffset;
+		locomotionRenderSceneLocation = sceneLocation;
+	}
+	bool grounded = kinematicMover.IsGrounded() || navWalker.IsOnNavMesh();
+	inAir = !grounded;
+	if (wasGrounded != grounded) onGroundStateChanged.Broadcast(grounded);
+	navWalkingQueries = navWalker.queries;
+}
+
+void AVRMovement::RemoveLocomotionRenderOffset()
+{
+	if (!player || locomotionRenderOffset.IsZero()) return;
+	if (player->scene->RelativeLocation.Equals(locomotionRenderSceneLocation, 0.01f)) player->scene->SetRelativeLocation(locomotionSceneLocation);
+	locomotionRenderOffset = FVector::ZeroVector;
+}
+
+void AVRMovement::StepLocomotion(const FVector& desiredVelocity, float deltaTime, const ANavigationData* navData)
+{
+	UFloatingPawnMovement* floatingMovement = player->floatingMovement;
+	UCapsuleComponent* capsule = player->movementCapsule;
+
+	// Walk along the nav-mesh once the capsule is standing on it, nothing is swept or traced while on it.
+	if (navData && (navWalker.IsOnNavMesh() || kinematicMover.IsGrounded()))
+	{
+		FVector velocity = kinematicMover.Accelerate(desiredVelocity, deltaTime, floatingMovement->Acceleration, floatingMovement->Deceleration);
+		FVector feetLocation = player->scene->GetComponentLocation() - locomotionRenderOffset;
+		FVector newFeetLocation = feetLocation;
+		if (navWalker.Move(navData, newFeetLocation, velocity * deltaTime, nullptr))
+		{
+			if (!newFeetLocation.Equals(feetLocation)) capsule->SetWorldLocation(capsule->GetComponentLocation() + newFeetLocation - feetLocation, false, nullptr, ETeleportType::TeleportPhysics);
+			return;
+		}
+	}
+	else navWalker.Reset();
+
+	// Off the nav-mesh the kinematic mover continues with the velocity it was walking at.
+	kinematicMover.Move(capsule, desiredVelocity, deltaTime, floatingMovement->Acceleration, floatingMovement->Deceleration, GetWorld()->GetGravityZ());
+}
+
 void AVRMovement::EnableCapsule(bool enable)
 {
 	// Enable the capsules physics properties.
@@ -243,6 +596,9 @@ void AVRMovement::EnableCapsule(bool enable)
 
 void AVRMovement::UpdateMovement(AVRHand* movementHand, bool released)
 {
+	// The teleport aim task started in the pawns tick has to finish before any teleport state is used.
+	WaitForTeleportAim();
+
 	// Ensure player is valid.
 	if (player)
 	{
@@ -296,13 +652,17 @@ void AVRMovement::UpdateMovement(AVRHand* movementHand, bool released)
 				case EVRMovementMode::Joystick:
 				case EVRMovementMode::SwingingArms:
 
-					// Update the controller movement mode. If released and vignette is enabled ramp the opacity back down to invisible at the specified speed.
-					if (released && vignetteDuringMovement && vignetteMAT) GetWorld()->GetTimerManager().SetTimer(vignetteTimer, this, &AVRMovement::ResetVignette, 0.01f, true);
+					// Update the controller movement mode. If released the vignette is faded back out from the tick.
+					if (released) canApplyVignette = false;
 					else UpdateControllerMovement(movementHand);
 				
 				break;
 			}
 
+			// Teleport aim results are only valid for the frame they were found in.
+			teleportAimEvaluated = false;
+			teleportAimReused = false;
+
 			// Adjust first move variable.
 			if (released)
 			{
@@ -498,36 +858,41 @@ void AVRMovement::UpdateDeveloperMovement(float deltaTime)
 }
 #endif
 
-void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
+void AVRMovement::RecenterCapsule()
 {
-	// Lerp opacity to visible. visible opacity = 0.0f
-	if (vignetteDuringMovement && canApplyVignette && vignetteMAT && lastVignetteOpacity > 0.0f)
+	// NOTE: Could add some sort of validation here for checking the nav-mesh for closest available point.
+	// Work from where the room would be without the fixed step render offset, placing it below drops the offset until the next frame adds it again.
+	UCapsuleComponent* capsule = player->movementCapsule;
+	FVector cameraLocation = player->camera->GetComponentLocation() - locomotionRenderOffset;
+	FVector sceneLocation = player->scene->GetComponentLocation() - locomotionRenderOffset;
+	FVector capsuleLocation = capsule->GetComponentLocation();
+	FVector targetLocation = FVector(cameraLocation.X, cameraLocation.Y, sceneLocation.Z + capsule->GetUnscaledCapsuleHalfHeight());
 	{
-		// stop vignette reset function is playing on the world timer.
-		GetWorld()->GetTimerManager().ClearTimer(vignetteTimer);
-		// Lerp to location.
-		LerpVignette(0.0f);
+		// Hold back the capsules transform propagation and overlaps until the room has been put back.
+		FScopedMovementUpdate capsuleUpdate(capsule, EScopedUpdate::DeferredUpdates);
+
+		// Sweep the capsule to the camera, stopping at anything in the way.
+		FHitResult hit;
+		kinematicMover.MoveCapsule(capsule, targetLocation - capsuleLocation, hit);
+		FVector newCapsuleLocation = capsule->GetComponentLocation();
+		FVector moved = newCapsuleLocation - capsuleLocation;
+
+		// Place the room so the camera is over the capsules new location, when the sweep is blocked this pushes the camera back out of whatever stopped it.
+		FVector cameraOffset = cameraLocation - newCapsuleLocation;
+		player->scene->SetWorldLocation(FVector(sceneLocation.X - cameraOffset.X, sceneLocation.Y - cameraOffset.Y, sceneLocation.Z + moved.Z));
 	}
+	locomotionRenderOffset = FVector::ZeroVector;
+}
 
+void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
+{
 	// Update the capsule if the player is not inside of it.
 	FVector capsuleOffset = player->movementCapsule->GetComponentLocation() - player->camera->GetComponentLocation();
 	capsuleOffset.Z = 0;
 	float maxOffsetSizeBeforeReset = player->movementCapsule->GetUnscaledCapsuleRadius();
 
 	// If the capsule is not close enough to the player reset its position and reposition the player inside.
-	if (capsuleOffset.Size() > maxOffsetSizeBeforeReset && currentMovementMode != EVRMovementMode::Lean)
-	{
-		// NOTE: Could add some sort of validation here for checking the nav-mesh for closest available point.
-		// Move capsule to current player location.
-		FVector cameraLocation = player->camera->GetComponentLocation();
-		player->movementCapsule->SetWorldLocation(FVector(cameraLocation.X, cameraLocation.Y, player->scene->GetComponentLocation().Z + player->movementCapsule->GetUnscaledCapsuleHalfHeight()), true);
-		
-		// Move scene component the relative offset between the capsule and camera position on the x and y axis.
-		FVector cameraCapsuleOffset = player->movementCapsule->GetComponentTransform().InverseTransformPosition(player->camera->GetComponentLocation());
-		cameraCapsuleOffset.Z = 0.0f;
-		FVector newScenePosition = player->scene->GetComponentTransform().TransformPosition(-cameraCapsuleOffset);
-		player->scene->SetWorldLocation(newScenePosition);
-	}
+	if (capsuleOffset.Size() > maxOffsetSizeBeforeReset && currentMovementMode != EVRMovementMode::Lean) RecenterCapsule();
 
 	// Get the desired movement direction for the current movement mode.
 	FVector controllerDirectionNoZ;
@@ -589,7 +954,6 @@ void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
 		{
 			if (vignetteDuringMovement && canApplyVignette)
 			{
-				if (vignetteMAT) GetWorld()->GetTimerManager().SetTimer(vignetteTimer, this, &AVRMovement::ResetVignette, 0.01f, true);
 				canApplyVignette = false;
 			}
 			speedScale = 0.0f;
@@ -605,15 +969,33 @@ void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
 		{
 			originalMovementLocation = movementHand->controller->GetComponentLocation();
 			lastMovementLocation = originalMovementLocation;
+			swingingArmsVelocity = FVector::ZeroVector;
+			controllerSampler.Reset();
 		}
 
 		// Get the current movement location of the controller in the world.
 		FVector currentMovementLocation = movementHand->controller->GetComponentLocation();
-		FVector movementDirection = lastMovementLocation - currentMovementLocation;
-
-		// Get movement direction and speed scale.
-		controllerDirectionNoZ = movementDirection.GetSafeNormal();
-		speedScale = FMath::Clamp(movementDirection.Size(), 0.0f, 20.0f) / 20.0f;
+		if (useControllerSampler)
+		{
+			// Sample in tracking space so the players own movement doesn't feed back into the swing, then rotate the fitted velocity into the world with the room.
+			// Pick up any change to controllerSampleFrames while there is no history to lose.
+			if (controllerSampler.Num() == 0) controllerSampler.SetCapacity(controllerSampleFrames);
+			controllerSampler.Add(GetWorld()->GetRealTimeSeconds(), player->scene->GetComponentTransform().InverseTransformPosition(currentMovementLocation));
+			FVector trackingVelocity;
+			controllerSampler.GetVelocity(trackingVelocity);
+			swingingArmsVelocity = player->scene->GetComponentQuat().RotateVector(trackingVelocity);
+
+			// Move against the direction the arm is swinging.
+			controllerDirectionNoZ = -swingingArmsVelocity.GetSafeNormal();
+			speedScale = FMath::Clamp(swingingArmsVelocity.Size() / swingingArmsFullSpeed, 0.0f, 1.0f);
+		}
+		else
+		{
+			// Get movement direction and speed scale.
+			FVector movementDirection = lastMovementLocation - currentMovementLocation;
+			controllerDirectionNoZ = movementDirection.GetSafeNormal();
+			speedScale = FMath::Clamp(movementDirection.Size(), 0.0f, 20.0f) / 20.0f;
+		}
 		speedScale *= swingingArmsSpeed;
 
 		// Save this frames current as last movement so it can be used next frame.
@@ -625,11 +1007,7 @@ void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
 	{
 		// If the speed is greater than the min speed required to show the vignette, show it. Otherwise reset it.
 		if (speedScale > minVignetteSpeed) canApplyVignette = true;
-		else if (canApplyVignette)
-		{
-			GetWorld()->GetTimerManager().SetTimer(vignetteTimer, this, &AVRMovement::ResetVignette, 0.01f, true);
-			canApplyVignette = false;
-		}
+		else canApplyVignette = false;
 	}
 
 	// Don't allow any z direction.
@@ -641,43 +1019,87 @@ void AVRMovement::UpdateControllerMovement(AVRHand* movementHand)
 
 void AVRMovement::ResetVignette()
 {
-	// End the reset once the opacity has been reset.
-	if (lastVignetteOpacity < 1.0f) LerpVignette(1.0f);
-	else GetWorld()->GetTimerManager().ClearTimer(vignetteTimer);
+	// Fade out until movement is fast enough to apply it again.
+	canApplyVignette = false;
 }
 
-void AVRMovement::LerpVignette(float target)
+void AVRMovement::UpdateVignette(float DeltaTime)
 {
-	float newOpacity = UKismetMathLibrary::FInterpTo(lastVignetteOpacity, target, GetWorld()->GetDeltaSeconds(), vignetteTransitionSpeed);
-	lastVignetteOpacity = newOpacity;
-	vignetteMAT->SetScalarParameterValue("opacity", newOpacity);
+	if (!vignetteDuringMovement || !vignetteMAT || currentMovementMode == EVRMovementMode::Teleport || currentMovementMode == EVRMovementMode::Developer) return;
+
+	// Use how fast the player is actually moving rather than the input, so blocked movement doesn't darken the view.
+	bool kinematic = kinematicCapsule && currentMovementMode != EVRMovementMode::Lean;
+	FVector velocity = kinematic ? kinematicMover.velocity : player->floatingMovement->Velocity;
+	float speedRatio = walkingSpeed > 0.0f ? FVector2D(velocity.X, velocity.Y).Size() / walkingSpeed : 0.0f;
+	bool moving = canApplyVignette && currentMovingHand && speedRatio > minVignetteSpeed;
+	vignetteDriver.Update(moving ? 0.0f : 1.0f, DeltaTime, vignetteTransitionSpeed);
+
+	// Don't draw the vignette at all while it is invisible.
+	player->vignette->SetVisibility(vignetteDriver.GetOpacity() < 1.0f);
 }
 
 void AVRMovement::UpdateTeleport(AVRHand* movementHand)
 {
-	// Get rid of last frames spline and initially hide the teleport meshes.
-	DestroyTeleportSpline();
-
-	// Create the teleport spline.
-	FVector splineEndLocation;
 	FTransform splineStartTrasform = movementHand->movementTarget->GetComponentTransform();
-	bool validLocation = CreateTeleportSpline(splineStartTrasform, splineEndLocation);
 
-	if (validLocation)
+	// Use the arc found by the teleport aim task if it was started for this hand, with the transform it was started from so the visuals match.
+	if (teleportAimEvaluated && teleportAimHand != movementHand) teleportAimEvaluated = false;
+	if (teleportAimEvaluated) splineStartTrasform = teleportAimTransform;
+
+	// If the hand has barely moved since the last arc was made keep that arc and its result, otherwise re-create it.
+	if (teleportAimReused || (!teleportAimEvaluated && CanReuseTeleportArc(splineStartTrasform))) teleportArcUpdatesSkipped++;
+	else
 	{
-		// Continue to check if the location is valid if the end location is touching the ground.
-		if (requiresNavMesh) lastTeleportValid = ValidateTeleportLocation(splineEndLocation);
-		else  lastTeleportValid = true;
+		// Initially hide the teleport ring. Last frames arc is rebuilt in place by CreateTeleportSpline.
+		teleportRing->SetVisibility(false, true);
 
-		// If the last valid location is a valid location update the ring and arrow to that location and show them in game.
-		if (lastTeleportValid)
+		// Create the teleport spline.
+		FVector splineEndLocation;
+		teleportArcLanded = CreateTeleportSpline(splineStartTrasform, splineEndLocation);
+		lastTeleportArcTransform = splineStartTrasform;
+		teleportAnchorSnapped = false;
+
+		if (teleportArcLanded)
 		{
+			// Snap to the nearest anchor the arc landed close to, anchors are placed on valid locations so skip validating it.
+			FTeleportAnchorIndex* anchorIndex = useTeleportAnchors ? FTeleportAnchorIndex::Get(GetWorld(), false) : nullptr;
+			const FTeleportAnchor* anchor = anchorIndex ? anchorIndex->FindNearest(splineEndLocation) : nullptr;
+			if (anchor)
+			{
+				teleportAnchorSnapped = true;
+				teleportAnchorSetsRotation = anchor->setRotation;
+				teleportAnchorRotation = anchor->rotation;
+				lastTeleportValid = true;
+				splineEndLocation = anchor->location;
+				teleportAnchorSnaps++;
+			}
+			// Continue to check if the location is valid if the end location is touching the ground.
+			else if (teleportAimEvaluated)
+			{
+				lastTeleportValid = teleportAimValid;
+				splineEndLocation = teleportAimLocation;
+			}
+			else if (requiresNavMesh) lastTeleportValid = ValidateTeleportLocation(splineEndLocation);
+			else  lastTeleportValid = true;
+
 			// Update the last valid teleport location.
-			lastValidTeleportLocation = splineEndLocation;
+			if (lastTeleportValid) lastValidTeleportLocation = splineEndLocation;
+		}
+	}
 
-			// Update the rotation direction depending on the thumb offset dead zone.
+	if (teleportArcLanded)
+	{
+		// If the last valid location is a valid location update the ring and arrow to that location and show them in game.
+		if (lastTeleportValid)
+		{
+			// Update the rotation direction from the snapped anchor or depending on the thumb offset dead zone.
 			FVector thumbOffset = FVector(movementHand->thumbstick.X, movementHand->thumbstick.Y, 0.0f);
-			if (thumbOffset.Size() > FMath::Clamp(teleportDeadzone, 0.0f, 1.0f))
+			if (teleportAnchorSnapped && teleportAnchorSetsRotation)
+			{
+				teleportRotation = teleportAnchorRotation;
+				if (!teleportArrow->IsVisible()) teleportArrow->SetVisibility(true);
+			}
+			else if (thumbOffset.Size() > FMath::Clamp(teleportDeadzone, 0.0f, 1.0f))
 			{
 				FRotator thumbRotation = UKismetMathLibrary::FindLookAtRotation(FVector::ZeroVector, thumbOffset);
 				teleportRotation = FRotator(thumbRotation.Pitch, player->camera->GetComponentRotation().Yaw + thumbRotation.Yaw + 90.0f, thumbRotation.Roll);
@@ -699,11 +1121,113 @@ void AVRMovement::UpdateTeleport(AVRHand* movementHand)
 		// Otherwise update the teleport material to invalid and disable lastTeleportValid.
 		else UpdateTeleportMaterials(false);
 	}
+
+	// Start loading the destination if the player has settled on it.
+	UpdateTeleportPrewarm();
+}
+
+void AVRMovement::UpdateTeleportOccupancy()
+{
+	// The grid is read by every synchronous arc, asynchronous traces are issued for the whole arc before it could be checked.
+	if (!useTeleportOccupancy || teleportTraceMode == EVRTeleportTraceMode::Asynchronous || !player) return;
+	bool teleportMode = currentMovementMode == EVRMovementMode::Teleport;
+#if WITH_EDITOR
+	teleportMode |= currentMovementMode == EVRMovementMode::Developer;
+#endif
+	if (!teleportMode) return;
+
+	// Start a new grid if the levels have changed or the player has left the middle of the current one.
+	if (teleportOccupancyDirty || !teleportOccupancyPending.IsBuilding())
+	{
+		FVector offset = player->scene->GetComponentLocation() - teleportOccupancyCenter;
+		bool outsideMiddle = FMath::Abs(offset.X) > teleportOccupancyExtent.X * 0.5f || FMath::Abs(offset.Y) > teleportOccupancyExtent.Y * 0.5f || FMath::Abs(offset.Z) > teleportOccupancyExtent.Z * 0.5f;
+		if (!teleportOccupancyDirty && teleportOccupancy.IsBuilt() && !outsideMiddle) return;
+
+		teleportOccupancyDirty = false;
+		teleportOccupancyPendingCenter = player->scene->GetComponentLocation();
+		teleportOccupancyPending.BeginBuild(teleportOccupancyPendingCenter, teleportOccupancyExtent, teleportOccupancyVoxelSize);
+		teleportOccupancyPendingTime = 0.0;
+		teleportOccupancyPendingTests = 0;
+	}
+
+	double startTime = FPlatformTime::Seconds();
+	int overlapTests = 0;
+	bool built = teleportOccupancyPending.ContinueBuild(GetWorld(), teleportTraceChannel, teleportQueryParams, teleportOccupancyBuildBudget / 1000.0, overlapTests);
+	teleportOccupancyPendingTime += FPlatformTime::Seconds() - startTime;
+	teleportOccupancyPendingTests += overlapTests;
+	if (!built) return;
+
+	// The teleport aim task reads the grid so only swap the new one in while it isn't running.
+	WaitForTeleportAim();
+	Swap(teleportOccupancy, teleportOccupancyPending);
+	teleportOccupancyPending.Empty();
+	teleportOccupancyCenter = teleportOccupancyPendingCenter;
+	teleportOccupancyBuildTime = (float)(teleportOccupancyPendingTime * 1000.0);
+	UE_LOG(LogVRMovement, Log, TEXT("Built the teleport occupancy grid in %.2fms with %i overlap tests."), teleportOccupancyBuildTime, teleportOccupancyPendingTests);
+}
+
+void AVRMovement::OnLevelsChanged(ULevel* level, UWorld* world)
+{
+	// Levels bring their nav-mesh tiles with them.
+	WaitForTeleportAim();
+	if (world == GetWorld())
+	{
+		// The grid could miss the new levels geometry so trace arcs in full until it is rebuilt.
+		teleportOccupancy.Empty();
+		teleportOccupancyDirty = true;
+		localCollision.Empty();
+	}
+}
+
+void AVRMovement::UpdateTeleportPrewarm()
+{
+	if (!prewarmTeleportDestination) return;
+
+	// Start counting again whenever the destination is lost or moves too far.
+	if (!teleportArcLanded || !lastTeleportValid || FVector::DistSquared(lastValidTeleportLocation, teleportPrewarmCandidate) > FMath::Square(teleportPrewarmTolerance))
+	{
+		teleportPrewarmCandidate = lastValidTeleportLocation;
+		teleportPrewarmStableFrames = 0;
+		return;
+	}
+
+	if (teleportPrewarmStableFrames < teleportPrewarmFrames)
+	{
+		teleportPrewarmStableFrames++;
+		return;
+	}
+
+	// Drop anything warmed for an old destination before warming the new one.
+	if (teleportPrewarmer.IsActive() && FVector::DistSquared(teleportPrewarmer.GetLocation(), teleportPrewarmCandidate) > FMath::Square(teleportPrewarmTolerance)) teleportPrewarmer.Reset();
+	teleportPrewarmer.Update(GetWorld(), teleportPrewarmCandidate, teleportPrewarmRadius);
+}
+
+void AVRMovement::UpdatePostTeleportStats(float DeltaTime)
+{
+	postTeleportFrameTime = FMath::Max(postTeleportFrameTime, DeltaTime * 1000.0f);
+	if (--postTeleportFramesLeft > 0) return;
+
+	// Keep a running average of the worst frame for warmed and cold teleports so the two can be compared.
+	if (postTeleportWarm)
+	{
+		postTeleportWarmCount++;
+		postTeleportFrameTimeWarm += (postTeleportFrameTime - postTeleportFrameTimeWarm) / postTeleportWarmCount;
+	}
+	else
+	{
+		postTeleportColdCount++;
+		postTeleportFrameTimeCold += (postTeleportFrameTime - postTeleportFrameTimeCold) / postTeleportColdCount;
+	}
+	UE_LOG(LogVRMovement, Log, TEXT("Post teleport frame time: %.2fms worst over %i frames, destination %s. Average warm %.2fms (%i), cold %.2fms (%i)."),
+		postTeleportFrameTime, postTeleportSampleFrames, postTeleportWarm ? TEXT("warmed") : TEXT("cold"), postTeleportFrameTimeWarm, postTeleportWarmCount, postTeleportFrameTimeCold, postTeleportColdCount);
+
+	// The level streaming has picked up any preloaded levels by now.
+	teleportPrewarmer.Reset();
 }
 
 bool AVRMovement::CreateTeleportSpline(FTransform startTransform, FVector& outLocation)
 {
-	teleportSpline->ClearSplinePoints();
+	teleportSpline->ClearSplinePoints(false);
 	teleportSpline->SetWorldLocationAndRotation(startTransform.GetLocation(), startTransform.GetRotation());
 
 	// Return false if the hand is too close to the world up vector.
@@ -713,14 +1237,13 @@ bool AVRMovement::CreateTeleportSpline(FTransform startTransform, FVector& outLo
 		FVector startPoint = startTransform.GetLocation();
 		FVector endPoint = startPoint + (startTransform.GetRotation().GetForwardVector() * 30.0f);
 
-		// Make spline mesh to go from start point to end point.
-		FName splineMeshName = MakeUniqueObjectName(this, USplineMeshComponent::StaticClass(), FName("SplineMesh"));
-		USplineMeshComponent* newMesh = NewObject<USplineMeshComponent>(this, splineMeshName);
-		newMesh->SetMobility(EComponentMobility::Movable);
-		newMesh->RegisterComponent();
-		newMesh->SetStaticMesh(teleportSplineMesh);
-		newMesh->SetStartAndEnd(startPoint, FVector(0.0f), endPoint, FVector(0.0f));
-		splineMeshes.Add(newMesh);
+		// Make the arc go straight from start point to end point.
+		ResetAsyncTeleportTraces();
+		teleportArcEndTime = -1.0f;
+		teleportArcPoints.Reset();
+		teleportArcPoints.Add(startPoint);
+		teleportArcPoints.Add(endPoint);
+		UpdateTeleportArc();
 
 		// Set location and show the end mesh at the endPoint.
 		teleportSplineEndMesh->SetWorldLocation(endPoint, false, nullptr, ETeleportType::TeleportPhysics);
@@ -733,44 +1256,24 @@ bool AVRMovement::CreateTeleportSpline(FTransform startTransform, FVector& outLo
 		return false;
 	}
 
-	// Projectile trace used to create the spline arc and find a teleport location.
+	// Projectile trace used to create the spline arc and find a teleport location, unless the teleport aim task has already found it.
 	FHitResult hit;
-	TArray<FVector> outPathPositions;
-	FVector outLastTraceDestination;
-
-	// Ignore self and ignore the player and anything thats currently held in the hand.
-	TArray<AActor*> actorsToIgnore;
-	actorsToIgnore.Add(player);
-	actorsToIgnore.Add(this);
-	actorsToIgnore.Add(currentMovingHand);
-	actorsToIgnore.Add(currentMovingHand->otherHand);
-
-	// Projectile trace the spline hit location and use each stage of the trace to create a spline from the shape.
-	UGameplayStatics::Blueprint_PredictProjectilePath_ByTraceChannel(GetWorld(), hit, outPathPositions, outLastTraceDestination, teleportSpline->GetComponentLocation(), teleportSpline->GetForwardVector() * teleportDistance, true, 0.0f, ECC_Visibility, false, actorsToIgnore, EDrawDebugTrace::None, 0.0f, 30.0f, 2.0f, teleportGravity);
-
-	// Set the spline up from the projectile trace.
-	for (FVector splinePoint : outPathPositions)
+	if (teleportAimEvaluated) hit = teleportAimHit;
+	else
 	{
-		teleportSpline->AddSplinePoint(splinePoint, ESplineCoordinateSpace::World);
+		PredictTeleportArc(teleportSpline->GetComponentLocation(), teleportSpline->GetForwardVector(), analyticTeleportArc, hit);
+		UpdateTeleportArcStats();
 	}
-	teleportSpline->SetSplinePointType(outPathPositions.Num() - 1, ESplinePointType::CurveClamped);
 
-	// DO A RESOLUTION SCALE FOR SCALING DOWN HOW MANY SPLINE MESHES ARE BEING CREATED.
-	// For each spline point of the current hands spline create a spline mesh between them and add them to an array.
-	for (int i = 0; i < teleportSpline->GetNumberOfSplinePoints() - 1; i++)
-	{
-		FName splineMeshName = MakeUniqueObjectName(this, USplineMeshComponent::StaticClass(), FName("SplineMesh"));
-		USplineMeshComponent* newMesh = NewObject<USplineMeshComponent>(this, splineMeshName);
-		newMesh->SetMobility(EComponentMobility::Movable);
-		newMesh->RegisterComponent();
-		newMesh->SetStaticMesh(teleportSplineMesh);
-		newMesh->SetStartAndEnd(teleportSpline->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World), teleportSpline->GetTangentAtSplinePoint(i, ESplineCoordinateSpace::World), teleportSpline->GetLocationAtSplinePoint(i + 1, ESplineCoordinateSpace::World), teleportSpline->GetTangentAtSplinePoint(i + 1, ESplineCoordinateSpace::World));
-		splineMeshes.Add(newMesh);
-	}
+	// Set the spline and arc mesh up from the projectile trace, re-sampled for how close it is to the camera.
+	UpdateTeleportArc();
 
 	// Set location and show the end mesh of the spline.
-	teleportSplineEndMesh->SetWorldLocation(teleportSpline->GetLocationAtSplinePoint(teleportSpline->GetNumberOfSplinePoints() - 1, ESplineCoordinateSpace::World), false, nullptr, ETeleportType::TeleportPhysics);
-	teleportSplineEndMesh->SetVisibility(true);
+	if (teleportArcPoints.Num() > 0)
+	{
+		teleportSplineEndMesh->SetWorldLocation(teleportArcPoints.Last(), false, nullptr, ETeleportType::TeleportPhysics);
+		teleportSplineEndMesh->SetVisibility(true);
+	}
 
 	// Check if the hit location is a valid navigatable point on the nav mesh and return valid hit as bool.
 	if (hit.bBlockingHit)
@@ -786,16 +1289,407 @@ bool AVRMovement::CreateTeleportSpline(FTransform startTransform, FVector& outLo
 	}
 }
 
-void AVRMovement::DestroyTeleportSpline()
+bool AVRMovement::PredictTeleportArc(const FVector& start, const FVector& direction, bool analytic, FHitResult& outHit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TeleportArcPredict);
+
+	bool async = teleportTraceMode == EVRTeleportTraceMode::Asynchronous;
+	if (analytic || async)
+	{
+		// Sample the whole arc in one batch then trace its segments until something is hit.
+		FTeleportArcParams arcParams;
+		arcParams.start = start;
+		arcParams.velocity = direction * teleportDistance;
+		arcParams.gravityZ = teleportGravity;
+		arcParams.maxSimTime = teleportArcMaxSimTime;
+		teleportArcParams = arcParams;
+
+		// Segments the occupancy grid shows can't hit static geometry or a movable body aren't traced by any of the synchronous arcs.
+		const FTeleportOccupancyGrid* occupancy = useTeleportOccupancy && teleportOccupancy.IsBuilt() ? &teleportOccupancy : nullptr;
+		teleportAimOccupancySkipped = 0;
+
+		// Step the arc with a few long traces and only refine the one that hit.
+		if (!async && refinedTeleportArc)
+		{
+			bool hitFound = FTeleportArcSolver::TraceArcRefined(GetWorld(), arcParams, teleportArcCoarseSegments, teleportArcRefineSteps, teleportArcClearanceRadius, teleportTraceChannel, teleportQueryParams,
+				teleportArcTimes, teleportArcPoints, outHit, teleportArcEndTime, teleportAimArcTraceCount, occupancy, &teleportAimOccupancySkipped);
+			teleportAimArcTraceSegments = teleportArcTimes.Num() - 1;
+			teleportArcCache.framesSinceFullTrace = 0;
+			return hitFound;
+		}
+
+		FTeleportArcSolver::SampleUniform(arcParams, GetTeleportArcTraceSegments(arcParams), teleportArcTimes, teleportArcPoints);
+		teleportAimArcTraceSegments = teleportArcTimes.Num() - 1;
+		if (!async)
+		{
+			bool hitFound = false;
+			if (!incrementalTeleportArc)
+			{
+				// Only trace the segments near static geometry or movable bodies.
+				if (occupancy) hitFound = occupancy->TraceArc(GetWorld(), teleportArcPoints, teleportTraceChannel, teleportQueryParams, outHit, teleportAimArcTraceCount, teleportAimOccupancySkipped);
+				else hitFound = FTeleportArcSolver::TraceArc(GetWorld(), teleportArcPoints, teleportTraceChannel, teleportQueryParams, outHit, teleportAimArcTraceCount);
+				teleportArcCache.framesSinceFullTrace = 0;
+			}
+			else
+			{
+				// Only re-trace the segments that have moved since they were last traced.
+				int tracesSaved = 0;
+				hitFound = teleportArcCache.TraceArc(GetWorld(), teleportArcPoints, teleportTraceChannel, teleportQueryParams, teleportArcRetraceTolerance, teleportArcRefreshFrames, outHit, teleportAimArcTraceCount, tracesSaved,
+					occupancy, &teleportAimOccupancySkipped);
+				teleportAimTracesSaved += tracesSaved;
+			}
+			UpdateTeleportArcEndTime(hitFound, outHit);
+			return hitFound;
+		}
+
+		// Issue this frames traces, then show last frames arc together with its own results so the visuals always match what was traced.
+		TArray<FTraceHandle> newArcTraces;
+		FTeleportArcSolver::TraceArcAsync(GetWorld(), teleportArcPoints, teleportTraceChannel, teleportQueryParams, newArcTraces);
+		teleportAimArcTraceCount = newArcTraces.Num();
+
+		bool resolved = false;
+		bool hitFound = false;
+		if (pendingArcTraces.Num() > 0)
+		{
+			Swap(teleportArcPoints, pendingArcPoints);
+			Swap(teleportArcParams, pendingArcParams);
+			hitFound = FTeleportArcSolver::ResolveArcAsync(GetWorld(), pendingArcTraces, teleportArcPoints, outHit, resolved);
+			if (!resolved)
+			{
+				teleportArcPoints = pendingArcPoints;
+				teleportArcParams = pendingArcParams;
+			}
+		}
+		else
+		{
+			pendingArcPoints = teleportArcPoints;
+			pendingArcParams = teleportArcParams;
+		}
+		pendingArcTraces = MoveTemp(newArcTraces);
+
+		// On the first frame of aiming or if last frames results are gone trace this frames arc on the game thread so nothing is skipped.
+		if (!resolved)
+		{
+			int syncTraceCount = 0;
+			hitFound = FTeleportArcSolver::TraceArc(GetWorld(), teleportArcPoints, teleportTraceChannel, teleportQueryParams, outHit, syncTraceCount);
+			teleportAimArcTraceCount += syncTraceCount;
+		}
+		UpdateTeleportArcEndTime(hitFound, outHit);
+		return hitFound;
+	}
+
+	// Projectile trace the spline hit location and use each stage of the trace to create a spline from the shape.
+	FVector outLastTraceDestination;
+	UGameplayStatics::Blueprint_PredictProjectilePath_ByTraceChannel(GetWorld(), outHit, teleportArcPoints, outLastTraceDestination, start, direction * teleportDistance, true, 0.0f, teleportTraceChannel, false, teleportIgnoredActors, EDrawDebugTrace::None, 0.0f, teleportArcSimFrequency, teleportArcMaxSimTime, teleportGravity);
+	teleportAimArcTraceCount = FMath::Max(teleportArcPoints.Num() - 1, 0);
+	teleportAimArcTraceSegments = teleportAimArcTraceCount;
+	teleportArcEndTime = -1.0f;
+	teleportArcCache.framesSinceFullTrace = 0;
+	return outHit.bBlockingHit;
+}
+
+void AVRMovement::ResetAsyncTeleportTraces()
+{
+	pendingArcTraces.Reset();
+	pendingArcPoints.Reset();
+	pendingFloorTrace = FTraceHandle();
+	hasAsyncFloorError = false;
+	teleportArcCache.Reset();
+}
+
+void AVRMovement::BenchmarkTeleportArc(int iterations)
 {
-	// Clear the spline mesh array of any components.
-	if (splineMeshes.Num() != 0)
+	CHECK_RETURN(LogVRMovement, !player, "BenchmarkTeleportArc: The movement actor %s has not been setup with a player.", *GetName());
+
+	// Fire from the hand that is currently moving or the right hand, otherwise straight out from the camera.
+	AVRHand* benchmarkHand = currentMovingHand ? currentMovingHand : player->rightHand;
+	FTransform startTransform = benchmarkHand ? benchmarkHand->movementTarget->GetComponentTransform() : player->camera->GetComponentTransform();
+	FVector start = startTransform.GetLocation();
+	FVector direction = startTransform.GetRotation().GetForwardVector();
+
+	// Run every solver synchronously with full traces so each iteration costs the same and nothing async or cached is touched.
+	WaitForTeleportAim();
+	EVRTeleportTraceMode oldTraceMode = teleportTraceMode;
+	bool wasIncremental = incrementalTeleportArc;
+	bool wasRefined = refinedTeleportArc;
+	teleportTraceMode = EVRTeleportTraceMode::Synchronous;
+	incrementalTeleportArc = false;
+
+	// Keep the arc that is being aimed so it can be put back afterwards.
+	TArray<FVector> oldArcPoints = teleportArcPoints;
+	TArray<float> oldArcTimes = teleportArcTimes;
+	FTeleportArcParams oldArcParams = teleportArcParams;
+	float oldArcEndTime = teleportArcEndTime;
+
+	// Time each solver and keep the landing location of the last run to compare them. Solver 0 is analytic, 1 is analytic with refined coarse traces and 2 is PredictProjectilePath.
+	FHitResult hit;
+	FVector landing[3];
+	double seconds[3];
+	int traces[3];
+	for (int solver = 0; solver < 3; solver++)
 	{
-		for (USplineMeshComponent* splineMesh : splineMeshes)
+		bool analytic = solver != 2;
+		refinedTeleportArc = solver == 1;
+		double startTime = FPlatformTime::Seconds();
+		for (int i = 0; i < iterations; i++)
 		{
-			splineMesh->DestroyComponent();
+			PredictTeleportArc(start, direction, analytic, hit);
 		}
-		splineMeshes.Empty();
+		seconds[solver] = FPlatformTime::Seconds() - startTime;
+		traces[solver] = teleportAimArcTraceCount;
+		landing[solver] = teleportArcPoints.Num() > 0 ? teleportArcPoints.Last() : start;
+	}
+	refinedTeleportArc = wasRefined;
+	incrementalTeleportArc = wasIncremental;
+	teleportTraceMode = oldTraceMode;
+	teleportArcPoints = MoveTemp(oldArcPoints);
+	teleportArcTimes = MoveTemp(oldArcTimes);
+	teleportArcParams = oldArcParams;
+	teleportArcEndTime = oldArcEndTime;
+
+	UE_LOG(LogVRMovement, Log, TEXT("BenchmarkTeleportArc: %d arcs. Analytic %.2fus/arc with %d traces, Refined %.2fus/arc with %d traces, PredictProjectilePath %.2fus/arc with %d traces."),
+		iterations, (seconds[0] / iterations) * 1000000.0, traces[0], (seconds[1] / iterations) * 1000000.0, traces[1], (seconds[2] / iterations) * 1000000.0, traces[2]);
+	UE_LOG(LogVRMovement, Log, TEXT("BenchmarkTeleportArc: Landing difference from PredictProjectilePath, Analytic %.2fcm, Refined %.2fcm."),
+		FVector::Dist(landing[0], landing[2]), FVector::Dist(landing[1], landing[2]));
+
+	// The refined landing should be at least as close to the dense path as the clearance sweep allows.
+	if (FVector::Dist(landing[1], landing[2]) > FMath::Max(teleportArcClearanceRadius * 2.0f, teleportArcTraceError))
+	{
+		UE_LOG(LogVRMovement, Warning, TEXT("BenchmarkTeleportArc: The refined arc landed %.2fcm from PredictProjectilePath."), FVector::Dist(landing[1], landing[2]));
+	}
+}
+
+void AVRMovement::BakeTeleportGrids(float cellSize)
+{
+	CHECK_RETURN(LogVRMovement, !player, "BakeTeleportGrids: The movement actor %s has not been setup with a player.", *GetName());
+
+	// Bake with the same floor types, nav agent and search distance the live query uses.
+	FTeleportGridBakeSettings settings;
+	settings.cellSize = cellSize > 0.0f ? cellSize : teleportGridCellSize;
+	settings.searchDistance = teleportSearchDistance;
+	settings.teleportableTypes = teleportableTypes;
+	settings.navAgentProps = player->floatingMovement->GetNavAgentPropertiesRef();
+	settings.actorsToIgnore = teleportIgnoredActors;
+
+	for (ULevel* level : GetWorld()->GetLevels())
+	{
+		if (level && level->bIsVisible) FTeleportValidityGrid::Bake(GetWorld(), level, settings);
+	}
+
+	// Map the new grids in next time they are looked up.
+	teleportGrids.Empty();
+}
+
+void AVRMovement::LaunchTeleportAim(AVRHand* movementHand)
+{
+	if (teleportTraceMode != EVRTeleportTraceMode::WorkerThread || !player || !movementHand || teleporting || teleportAimTask.IsValid()) return;
+	if (currentMovementMode != EVRMovementMode::Teleport && currentMovementMode != EVRMovementMode::Developer) return;
+
+	// Pointing straight up only shows a short line which is left to the game thread.
+	FTransform startTransform = movementHand->movementTarget->GetComponentTransform();
+	if (FMath::IsNearlyEqual(startTransform.GetRotation().GetForwardVector().Z, 1.0f, 0.3f)) return;
+
+	// Nothing needs doing if last frames arc can be kept.
+	if (CanReuseTeleportArc(startTransform))
+	{
+		teleportAimReused = true;
+		return;
+	}
+
+	// Anything that touches UObjects is done here, the task only reads the arc inputs and writes the arc and nav results.
+	if (useTeleportGrid) teleportGrids.UpdateLevels(GetWorld());
+	teleportAimTransform = startTransform;
+	teleportAimHand = movementHand;
+	ANavigationData* navData = requiresNavMesh ? GetTeleportNavData() : nullptr;
+	teleportAimNavData = navData;
+	teleportAimNavFilter = navData ? navData->GetDefaultQueryFilter() : nullptr;
+	teleportAimTask = FFunctionGraphTask::CreateAndDispatchWhenReady([this]()
+	{
+		EvaluateTeleportAim();
+	}, TStatId(), nullptr, ENamedThreads::AnyHiPriThreadNormalTask);
+}
+
+void AVRMovement::EvaluateTeleportAim()
+{
+	// Scene queries take their own read locks. The nav data and filter were found on the game thread, which waits for this task before anything changes the nav-mesh or the nav cache.
+	teleportAimHit = FHitResult();
+	teleportAimLanded = PredictTeleportArc(teleportAimTransform.GetLocation(), teleportAimTransform.GetRotation().GetForwardVector(), true, teleportAimHit);
+	teleportAimValid = false;
+	if (teleportAimLanded)
+	{
+		teleportAimLocation = teleportAimHit.Location + teleportAimHit.Normal;
+		teleportAimValid = !requiresNavMesh || ValidateTeleportLocation(teleportAimLocation, teleportAimNavData, teleportAimNavFilter);
+	}
+}
+
+void AVRMovement::WaitForTeleportAim()
+{
+	if (!teleportAimTask.IsValid()) return;
+	FTaskGraphInterface::Get().WaitUntilTaskCompletes(teleportAimTask, ENamedThreads::GameThread);
+	teleportAimTask = nullptr;
+	teleportAimEvaluated = true;
+	teleportAimNavData = nullptr;
+	teleportAimNavFilter = nullptr;
+
+	// Stats are only written on the game thread.
+	UpdateTeleportArcStats();
+	UpdateTeleportNavStats();
+}
+
+bool AVRMovement::CanReuseTeleportArc(const FTransform& startTransform)
+{
+	if (!incrementalTeleportArc || !analyticTeleportArc || !teleportArc->IsVisible() || teleportTraceMode == EVRTeleportTraceMode::Asynchronous) return false;
+
+	// Still re-create the arc every so often so anything that has moved into it is found.
+	if (teleportArcCache.framesSinceFullTrace + 1 >= teleportArcRefreshFrames) return false;
+
+	// A change in direction moves the end of the arc by roughly the angle times the length of the arc.
+	float arcLength = teleportDistance * teleportArcMaxSimTime;
+	float directionChange = (startTransform.GetRotation().GetForwardVector() - lastTeleportArcTransform.GetRotation().GetForwardVector()).Size() * arcLength;
+	float locationChange = FVector::Dist(startTransform.GetLocation(), lastTeleportArcTransform.GetLocation());
+	if (locationChange + directionChange > teleportArcRetraceTolerance) return false;
+
+	// The whole arc is kept so count every segment as saved.
+	teleportArcCache.framesSinceFullTrace++;
+	teleportTracesSaved += FMath::Max(teleportArcPoints.Num() - 1, 0);
+	return true;
+}
+
+void AVRMovement::SetupBlackoutJobs()
+{
+	if (blackoutJobs.Num() > 0) return;
+	FTeleportBlackoutQueue* blackoutQueue = FTeleportBlackoutQueue::Get(GetWorld(), true);
+
+	// Finish destroying anything the last garbage collection found unreachable.
+	if (blackoutPurgeGarbage)
+	{
+		blackoutJobs.Add(blackoutQueue->Add("PurgeGarbage", [](double budget)
+		{
+			if (IsIncrementalPurgePending()) IncrementalPurgeGarbage(true, (float)budget);
+			return !IsIncrementalPurgePending();
+		}, true));
+	}
+
+	// Let level and asset loads that are in flight take more time than they would get in a visible frame.
+	if (blackoutProcessLoading)
+	{
+		blackoutJobs.Add(blackoutQueue->Add("ProcessLoading", [](double budget)
+		{
+			if (IsAsyncLoading()) ProcessAsyncLoading(true, true, (float)budget);
+			return !IsAsyncLoading();
+		}, true));
+	}
+}
+
+void AVRMovement::UpdateBlackout()
+{
+	blackoutDrained = false;
+	if (!useBlackoutQueue || !playerController || !playerController->PlayerCameraManager) return;
+
+	// Only the teleports own fade counts, other fades such as menus or cut-scenes can still be watched through.
+	if (!teleporting || playerController->PlayerCameraManager->FadeAmount < blackoutFadeThreshold) return;
+
+	FTeleportBlackoutQueue* blackoutQueue = FTeleportBlackoutQueue::Get(GetWorld(), false);
+	if (!blackoutQueue || !blackoutQueue->HasWork()) return;
+
+	// Jobs can load levels or collect garbage so the teleport aim task must not be reading the world while they run.
+	WaitForTeleportAim();
+
+	int jobsRun = 0;
+	blackoutWorkTime = (float)(blackoutQueue->Drain(blackoutWorkBudget / 1000.0f, jobsRun) * 1000.0);
+	blackoutJobsRun += jobsRun;
+	blackoutDrained = true;
+}
+
+void AVRMovement::SetupTeleportQuery()
+{
+	teleportIgnoredActors.Reset();
+	teleportQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(TeleportArc), false);
+	CHECK_RETURN(LogVRMovement, !player, "SetupTeleportQuery: The movement actor %s has not been setup with a player.", *GetName());
+
+	// Hands, the capsule and UI ignore the teleport channel already so these are only a fallback for any of their components using another profile.
+	teleportIgnoredActors.Add(player);
+	teleportIgnoredActors.Add(this);
+	if (player->leftHand) teleportIgnoredActors.Add(player->leftHand);
+	if (player->rightHand) teleportIgnoredActors.Add(player->rightHand);
+	teleportQueryParams.AddIgnoredActors(teleportIgnoredActors);
+
+	// Held props are skipped by the arc without touching their own collision responses.
+	teleportIgnoredComponents.RemoveAll([](const TWeakObjectPtr<UPrimitiveComponent>& component) { return !component.IsValid(); });
+	for (const TWeakObjectPtr<UPrimitiveComponent>& component : teleportIgnoredComponents)
+	{
+		teleportQueryParams.AddIgnoredComponent(component.Get());
+	}
+}
+
+void AVRMovement::SetIgnoredByTeleport(UPrimitiveComponent* component, bool ignore)
+{
+	if (!component) return;
+
+	// The teleport aim task reads the query params so only change them while it isn't running.
+	WaitForTeleportAim();
+	if (ignore) teleportIgnoredComponents.AddUnique(component);
+	else teleportIgnoredComponents.Remove(component);
+	SetupTeleportQuery();
+
+	// Cached segment results may have hit the component.
+	teleportArcCache.Reset();
+}
+
+int AVRMovement::GetTeleportArcTraceSegments(const FTeleportArcParams& arcParams) const
+{
+	if (!adaptiveTeleportArc) return FMath::CeilToInt(teleportArcMaxSimTime * teleportArcSimFrequency);
+	return FMath::Clamp(FMath::CeilToInt(arcParams.maxSimTime / FTeleportArcSolver::GetTimeStepForError(arcParams, teleportArcTraceError)), 1, teleportArcMaxSegments);
+}
+
+void AVRMovement::UpdateTeleportArcEndTime(bool hitFound, const FHitResult& hit)
+{
+	// Find how far through the segment it ended in the arc was hit, the times still hold the end of that segment.
+	teleportArcEndTime = teleportArcParams.maxSimTime;
+	int hitSegment = teleportArcPoints.Num() - 2;
+	if (hitFound && hitSegment >= 0 && hitSegment + 1 < teleportArcTimes.Num())
+	{
+		teleportArcEndTime = FMath::Lerp(teleportArcTimes[hitSegment], teleportArcTimes[hitSegment + 1], hit.Time);
+	}
+}
+
+void AVRMovement::UpdateTeleportArc()
+{
+	// Re-sample analytic arcs for display so segments are only as short as they need to be to look smooth from the camera.
+	const TArray<FVector>* visualPoints = &teleportArcPoints;
+	if (adaptiveTeleportArc && teleportArcEndTime > 0.0f && player && teleportArcPoints.Num() > 1)
+	{
+		float errorPerDistance = teleportArcPixelError / (teleportArcPixelsPerDegree * (180.0f / PI));
+		FTeleportArcSolver::SampleAdaptive(teleportArcParams, teleportArcEndTime, player->camera->GetComponentLocation(), 0.0f, errorPerDistance, teleportArcMaxSegments, teleportArcVisualTimes, teleportArcVisualPoints);
+
+		// End exactly where the trace did.
+		teleportArcVisualPoints.Last() = teleportArcPoints.Last();
+		visualPoints = &teleportArcVisualPoints;
+	}
+	teleportArcVisualSegments = FMath::Max(visualPoints->Num() - 1, 0);
+
+	// Set all the spline points at once so the spline is only updated a single time.
+	teleportSpline->SetSplinePoints(*visualPoints, ESplineCoordinateSpace::World, false);
+	if (visualPoints->Num() > 0) teleportSpline->SetSplinePointType(visualPoints->Num() - 1, ESplinePointType::CurveClamped, false);
+	teleportSpline->UpdateSpline();
+
+	// Rebuild the arc mesh in place along the same points.
+	teleportArc->UpdateArc(*visualPoints);
+}
+
+void AVRMovement::DestroyTeleportSpline()
+{
+	// Hide the arc, its vertex buffers are kept to be rebuilt in place next time the arc is shown.
+	WaitForTeleportAim();
+	teleportAimEvaluated = false;
+	teleportArc->ClearArc();
+	ResetAsyncTeleportTraces();
+
+	// A cancelled aim won't be teleported to so let go of anything loaded for it, a valid one is released after the post teleport stats.
+	if (!lastTeleportValid)
+	{
+		teleportPrewarmer.Reset();
+		teleportPrewarmStableFrames = 0;
 	}
 
 	// Hide any of the visuals such as the end of the spline mesh, ring and arrow.
@@ -803,26 +1697,105 @@ void AVRMovement::DestroyTeleportSpline()
 	teleportRing->SetVisibility(false, true);
 }
 
-bool AVRMovement::ValidateTeleportLocation(FVector& location)
+ANavigationData* AVRMovement::GetTeleportNavData()
 {
 	UNavigationSystemV1* navSystem = Cast<UNavigationSystemV1>(GetWorld()->GetNavigationSystem());
-	if (navSystem)
+	if (!navSystem || !player) return nullptr;
+
+	// Get the nav properties from the players movement component to determine player width, height etc.
+	const FNavAgentProperties& props = player->floatingMovement->GetNavAgentPropertiesRef();
+	return useTeleportNavCache ? teleportNavCache.GetNavData(navSystem, props) : navSystem->GetNavDataForProps(props);
+}
+
+void AVRMovement::UpdateTeleportArcStats()
+{
+	teleportArcTraceCount = teleportAimArcTraceCount;
+	teleportArcTraceSegments = teleportAimArcTraceSegments;
+	teleportOccupancySkipped = teleportAimOccupancySkipped;
+	teleportTracesSaved += teleportAimTracesSaved;
+	teleportAimTracesSaved = 0;
+}
+
+void AVRMovement::UpdateTeleportNavStats()
+{
+	teleportGridHits = teleportGrids.hits;
+	teleportGridFallbacks = teleportGrids.fallbacks;
+	teleportNavCacheHits = teleportNavCache.hits;
+	teleportNavCacheMisses = teleportNavCache.misses;
+	teleportNavPolysTested = teleportAimPolysTested;
+}
+
+bool AVRMovement::ValidateTeleportLocation(FVector& location)
+{
+	ANavigationData* navData = GetTeleportNavData();
+	bool valid = ValidateTeleportLocation(location, navData, navData ? navData->GetDefaultQueryFilter() : nullptr);
+	UpdateTeleportNavStats();
+	return valid;
+}
+
+bool AVRMovement::ValidateTeleportLocation(FVector& location, const ANavigationData* navData, FSharedConstNavQueryFilter navFilter)
+{
+	// Look the location up in the baked grids first, only dynamic or un-baked areas need the nav-mesh.
+	if (useTeleportGrid)
+	{
+		float gridHeight;
+		ETeleportGridResult gridResult = teleportGrids.Lookup(IsInGameThread() ? GetWorld() : nullptr, location, teleportSearchDistance, gridHeight);
+		if (gridResult == ETeleportGridResult::Valid)
+		{
+			location.Z = gridHeight;
+			return true;
+		}
+		else if (gridResult == ETeleportGridResult::Invalid) return false;
+	}
+
+	if (navData)
 	{		
-		// Get the nav properties from the players movement component to determine player width, height etc.
 		FVector foundLocation;
 		FVector searchingExtent = FVector(teleportSearchDistance, teleportSearchDistance, teleportSearchDistance);
-		FNavAgentProperties props = player->floatingMovement->GetNavAgentPropertiesRef();
-		ANavigationData* navData = navSystem->GetNavDataForProps(props);
-		bool locationOnNav = navSystem->K2_ProjectPointToNavigation(GetWorld(), location, foundLocation, navData, nullptr, searchingExtent);
+		FVector firstExtent = progressiveTeleportNavSearch ? FVector(teleportMinSearchDistance) : searchingExtent;
+		int* polysTested = debugTeleportNavPolys ? &teleportAimPolysTested : nullptr;
+		bool locationOnNav = false;
+		if (useTeleportNavCache)
+		{
+			// Re-use the projection from the same area if its tile hasn't been rebuilt since.
+			locationOnNav = teleportNavCache.ProjectPoint(navData, location, searchingExtent, firstExtent, agentID, foundLocation, polysTested, navFilter);
+		}
+		else
+		{
+			// Start with a tight extent and only widen it if nothing is found.
+			FNavLocation navLocation;
+			locationOnNav = FTeleportNavCache::ProjectPointProgressive(navData, location, firstExtent, searchingExtent, navLocation, polysTested, navFilter);
+			if (locationOnNav) foundLocation = navLocation.Location;
+		}
 		// If the location is on the nav-mesh return true and set location to said found location.
 		if (locationOnNav)
 		{
 			// Do a final line trace to adjust the Z of the nav-mesh as it sometimes is not set up to be flush with the surface.
 			FHitResult navMeshHeightError;
-			FCollisionQueryParams floorTraceParams;
-			floorTraceParams.AddIgnoredActor(this);
-			floorTraceParams.AddIgnoredActor(player);
-			GetWorld()->LineTraceSingleByObjectType(navMeshHeightError, foundLocation, foundLocation - FVector(0.0f, 0.0f, 10.0f), teleportableTypes, floorTraceParams);
+			if (teleportTraceMode == EVRTeleportTraceMode::Asynchronous)
+			{
+				// Pick up last frames floor trace and remember how far the nav-mesh was from the floor there.
+				FTraceDatum floorData;
+				if (pendingFloorTrace.IsValid() && GetWorld()->QueryTraceData(pendingFloorTrace, floorData))
+				{
+					hasAsyncFloorError = floorData.OutHits.Num() > 0 && floorData.OutHits[0].bBlockingHit;
+					if (hasAsyncFloorError)
+					{
+						asyncFloorError = floorData.OutHits[0].Location.Z - pendingFloorLocation.Z;
+						asyncFloorErrorLocation = pendingFloorLocation;
+					}
+				}
+
+				// Trace under this frames location for next frame.
+				pendingFloorTrace = GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, foundLocation, foundLocation - FVector(0.0f, 0.0f, 10.0f), teleportableTypes, teleportQueryParams);
+				pendingFloorLocation = foundLocation;
+
+				// The nav-mesh height error is locally smooth so re-use the last one while aiming close to where it was found (30cm).
+				location = foundLocation;
+				if (hasAsyncFloorError && FVector::DistSquared2D(foundLocation, asyncFloorErrorLocation) < 900.0f) location.Z += asyncFloorError;
+				return true;
+			}
+			GetWorld()->LineTraceSingleByObjectType(navMeshHeightError, foundLocation, foundLocation - FVector(0.0f, 0.0f, 10.0f), teleportableTypes, teleportQueryParams);
 			if (navMeshHeightError.bBlockingHit) location = navMeshHeightError.Location;
 			// Otherwise if nothing is hit just use the nav meshes assumed location as it the next best option.
 			else location = foundLocation;
@@ -833,18 +1806,88 @@ bool AVRMovement::ValidateTeleportLocation(FVector& location)
 	else return false;
 }
 
-void AVRMovement::UpdateTeleportMaterials(bool valid)
+void AVRMovement::OnNavigationRebuilt(ANavigationData* navData)
+{
+	WaitForTeleportAim();
+	teleportNavCache.OnNavigationRebuilt(navData);
+}
+
+void AVRMovement::GetTeleportMeshes(TArray<UMeshComponent*, TInlineAllocator<4>>& outMeshes) const
+{
+	outMeshes.Reset();
+	outMeshes.Add(teleportSplineEndMesh);
+	outMeshes.Add(teleportRing);
+	outMeshes.Add(teleportArrow);
+	outMeshes.Add(teleportArc);
+}
+
+void AVRMovement::SetupTeleportMaterials()
 {
-	FLinearColor newColor = validTeleportColor;
-	if (!valid) newColor = invalidTeleportColor;
+	TArray<UMeshComponent*, TInlineAllocator<4>> meshes;
+	GetTeleportMeshes(meshes);
 
-	// Adjust the materials of the spline and spline end mesh to the valid tp material.
-	teleportSplineEndMesh->SetVectorParameterValueOnMaterials("Color", FVector(newColor.R, newColor.G, newColor.B));
-	teleportRing->SetVectorParameterValueOnMaterials("Color", FVector(newColor.R, newColor.G, newColor.B));
-	teleportArrow->SetVectorParameterValueOnMaterials("Color", FVector(newColor.R, newColor.G, newColor.B));
-	for (USplineMeshComponent* splineMesh : splineMeshes)
+	// Put back the meshes own materials if this has been setup before, so they are copied instead of last setups copies.
+	int index = 0;
+	for (UMeshComponent* mesh : meshes)
 	{
-		splineMesh->SetVectorParameterValueOnMaterials("Color", FVector(newColor.R, newColor.G, newColor.B));
+		for (int slot = 0; slot < FMath::Max(mesh->GetNumMaterials(), 1) && index < originalTeleportMaterials.Num(); slot++, index++)
+		{
+			mesh->SetMaterial(slot, originalTeleportMaterials[index]);
+		}
+	}
+	originalTeleportMaterials.Reset();
+	validTeleportMaterials.Reset();
+	invalidTeleportMaterials.Reset();
+	teleportMaterialState = -1;
+
+	// Create a single valid and invalid copy of each material used, no matter how many meshes or slots use it. The arc always has one slot even before its section is made.
+	TMap<UMaterialInterface*, TPair<UMaterialInterface*, UMaterialInterface*>> stateMaterials;
+	for (UMeshComponent* mesh : meshes)
+	{
+		for (int slot = 0; slot < FMath::Max(mesh->GetNumMaterials(), 1); slot++)
+		{
+			UMaterialInterface* material = mesh->GetMaterial(slot);
+			TPair<UMaterialInterface*, UMaterialInterface*>* pair = stateMaterials.Find(material);
+			if (!pair)
+			{
+				pair = &stateMaterials.Add(material, TPair<UMaterialInterface*, UMaterialInterface*>(validTeleportMaterial, invalidTeleportMaterial));
+				if (material && !pair->Key)
+				{
+					UMaterialInstanceDynamic* validMaterial = UMaterialInstanceDynamic::Create(material, this);
+					validMaterial->SetVectorParameterValue("Color", FLinearColor(validTeleportColor.R, validTeleportColor.G, validTeleportColor.B));
+					pair->Key = validMaterial;
+				}
+				if (material && !pair->Value)
+				{
+					UMaterialInstanceDynamic* invalidMaterial = UMaterialInstanceDynamic::Create(material, this);
+					invalidMaterial->SetVectorParameterValue("Color", FLinearColor(invalidTeleportColor.R, invalidTeleportColor.G, invalidTeleportColor.B));
+					pair->Value = invalidMaterial;
+				}
+			}
+			originalTeleportMaterials.Add(material);
+			validTeleportMaterials.Add(pair->Key);
+			invalidTeleportMaterials.Add(pair->Value);
+		}
+	}
+}
+
+void AVRMovement::UpdateTeleportMaterials(bool valid)
+{
+	// Only swap the materials when the state changes.
+	int newState = valid ? 1 : 0;
+	if (newState == teleportMaterialState) return;
+	teleportMaterialState = newState;
+
+	TArray<UMeshComponent*, TInlineAllocator<4>> meshes;
+	GetTeleportMeshes(meshes);
+	const TArray<UMaterialInterface*>& materials = valid ? validTeleportMaterials : invalidTeleportMaterials;
+	int index = 0;
+	for (UMeshComponent* mesh : meshes)
+	{
+		for (int slot = 0; slot < FMath::Max(mesh->GetNumMaterials(), 1) && index < materials.Num(); slot++, index++)
+		{
+			mesh->SetMaterial(slot, materials[index]);
+		}
 	}
 }
 
@@ -853,7 +1896,7 @@ void AVRMovement::TeleportCameraFade()
 	if (lastTeleportValid)
 	{
 		// If the teleport spline is still visible destroy it.
-		if (splineMeshes.Num() > 0) DestroyTeleportSpline();
+		if (teleportArc->IsVisible()) DestroyTeleportSpline();
 
 		// Fade the camera.
 		if (playerController) playerController->PlayerCameraManager->StartCameraFade(0.0f, 1.0f, cameraFadeTimeToLast, teleportFadeColor, false, true);
@@ -870,7 +1913,7 @@ void AVRMovement::TeleportCameraFade()
 void AVRMovement::TeleportPlayer()
 {
 	// If the teleport spline is still visible destroy it.
-	if (splineMeshes.Num() > 0) DestroyTeleportSpline();
+	if (teleportArc->IsVisible()) DestroyTeleportSpline();
 
 	// If in developer mode teleport capsule and raise from floor and teleport.
 	if (currentMovementMode == EVRMovementMode::Developer)
@@ -885,7 +1928,7 @@ void AVRMovement::TeleportPlayer()
 	else 
 	{
 		// Move the players location to the locationToTeleport facing in the rotationToFace.
-		if (teleportRotation == FRotator::ZeroRotator) player->MovePlayer(lastValidTeleportLocation);
+		if (teleportRotation == FRotator::ZeroRotator && !(teleportAnchorSnapped && teleportAnchorSetsRotation)) player->MovePlayer(lastValidTeleportLocation);
 		else player->MovePlayerWithRotation(lastValidTeleportLocation, teleportRotation);
 
 		// Un-fade the camera after teleport.
@@ -896,6 +1939,12 @@ void AVRMovement::TeleportPlayer()
 	// Disable the teleport.
 	lastTeleportValid = false;
 
+	// Time the next few frames to see if warming the destination paid off.
+	postTeleportWarm = teleportPrewarmer.IsActive() && FVector::DistSquared(teleportPrewarmer.GetLocation(), lastValidTeleportLocation) <= FMath::Square(teleportPrewarmTolerance);
+	postTeleportFramesLeft = FMath::Max(postTeleportSampleFrames, 1);
+	postTeleportFrameTime = 0.0f;
+	teleportPrewarmStableFrames = 0;
+
 	// Play teleport sound if it is not null.
 	if (teleportSound) UGameplayStatics::PlaySoundAtLocation(GetWorld(), teleportSound, player->camera->GetComponentLocation());
 }
\ No newline at end of file
@@ -5,19 +5,38 @@
 #include "GameFramework/Actor.h"
 #include "NavigationData.h"
 #include "NavQueryFilter.h"
+#include "WorldCollision.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Teleport/TeleportArcSolver.h"
+#include "Teleport/TeleportNavCache.h"
+#include "Teleport/TeleportValidityGrid.h"
+#include "Teleport/TeleportPrewarmer.h"
+#include "Teleport/TeleportBlackoutQueue.h"
+#include "Teleport/TeleportOccupancyGrid.h"
+#include "Movement/VRGroundTracker.h"
+#include "Movement/VRKinematicMover.h"
+#include "Movement/VRNavWalker.h"
+#include "Movement/VRLocalCollisionCache.h"
+#include "Movement/VRControllerSampler.h"
+#include "Movement/VRVignetteDriver.h"
 #include "Globals.h"
 #include "VRMovement.generated.h"
 
 /* Define this actors log category. */
 DECLARE_LOG_CATEGORY_EXTERN(LogVRMovement, Log, All);
 
+/* Stat group for the movement actors profiling counters. */
+DECLARE_STATS_GROUP(TEXT("VRMovement"), STATGROUP_VRMovement, STATCAT_Advanced);
+
 /* Declare classes used. */
 class USceneComponent;
 class USplineComponent;
+class UTeleportArcComponent;
 class UStaticMeshComponent;
 class UStaticMesh;
 class UMaterialInterface;
 class UMaterialInstanceDynamic;
+class UMeshComponent;
 class AVRPawn;
 class AVRHand;
 class APlayerController;
@@ -43,6 +62,15 @@ enum class EVRDirectionMode : uint8
 	Controller UMETA(DisplayName = "Controller", ToolTip = "For any directional movement modes use the current moving controllers look at direction to calculate relative directions."),
 };
 
+/* How the teleport arc and floor traces are issued while aiming. */
+UENUM(BlueprintType)
+enum class EVRTeleportTraceMode : uint8
+{
+	Synchronous UMETA(DisplayName = "Synchronous", ToolTip = "Trace the arc and floor on the game thread and use the results in the same frame."),
+	Asynchronous UMETA(DisplayName = "Asynchronous", ToolTip = "Issue the arc and floor traces through the worlds async trace API and show the results one frame later. Always uses the analytic arc solver."),
+	WorkerThread UMETA(DisplayName = "Worker Thread", ToolTip = "Find and validate the arc in a task started from the pawns pre physics tick and use the result in its post update tick of the same frame. Always uses the analytic arc solver."),
+};
+
 /* Developer input events. */
 UENUM(BlueprintType)
 enum class EVRInput : uint8
@@ -54,6 +82,9 @@ enum class EVRInput : uint8
 	HideRight,
 };
 
+/* Called when the player lands on or leaves the ground in the walking movement modes. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FVRGroundStateChanged, bool, grounded);
+
 /* The VRPawns Movement component class containing all virtual reality movement functionality.
  * NOTE: If movement mode is changed during runtime the SetupMovement function must be ran afterwards for the class to work correctly... */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent), Blueprintable, BlueprintType, hidecategories = (Rendering, Replication, Input, Actor, LOD, Cooking))
@@ -71,6 +102,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	USplineComponent* teleportSpline;
 
+	/* Single primitive that renders the whole teleport arc, its vertices are rebuilt in place from the projectile path each frame. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	UTeleportArcComponent* teleportArc;
+
 	/* Mesh used to show location to teleport to. */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	UStaticMeshComponent* teleportRing;
@@ -83,7 +118,7 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	UStaticMeshComponent* teleportSplineEndMesh;
 
-	/* Mesh to be procedurally placed along the teleport spline. */
+	/* Mesh whose first material is used for the teleport arc when no material has been set on the arc component. */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	UStaticMesh* teleportSplineMesh;
 
@@ -120,6 +155,14 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Movement|Teleport")
 	FLinearColor validTeleportColor;
 
+	/* Material shared by every teleport mesh while the location is valid. NOTE: If not set one copy of each meshes own material is made with the validTeleportColor. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Movement|Teleport")
+	UMaterialInterface* validTeleportMaterial;
+
+	/* Material shared by every teleport mesh while the location is invalid. NOTE: If not set one copy of each meshes own material is made with the invalidTeleportColor. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Movement|Teleport")
+	UMaterialInterface* invalidTeleportMaterial;
+
 	/* Camera fade on teleport to avoid motion sickness. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
 	bool teleportFade;
@@ -148,10 +191,298 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "-5000.0", UIMin = "0.0", ClampMax = "-5000.0", UIMax = "0.0"))
 	float teleportGravity;
 
+	/* Use the native closed form arc solver instead of the blueprint projectile path prediction to find the teleport arc. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool analyticTeleportArc;
+
+	/* How the teleport arc and floor traces are issued while aiming. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	EVRTeleportTraceMode teleportTraceMode;
+
+	/* Trace channel the teleport arc is traced on. NOTE: The Teleport channel is ignored by the HandSkel, PlayerCapsule and UI profiles so they are filtered out before any narrowphase test. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	TEnumAsByte<ECollisionChannel> teleportTraceChannel;
+
+	/* Number of teleport arc segments per second of simulated flight time. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1.0", UIMin = "5.0", UIMax = "60.0"))
+	float teleportArcSimFrequency;
+
+	/* Flight time in seconds after which the teleport arc ends if nothing has been hit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.1", UIMin = "0.5", UIMax = "5.0"))
+	float teleportArcMaxSimTime;
+
+	/* Pick the number of teleport arc segments from the error budgets below instead of teleportArcSimFrequency. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool adaptiveTeleportArc;
+
+	/* Furthest the traced segments can be from the real arc in cm. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.1", UIMin = "0.5", UIMax = "20.0"))
+	float teleportArcTraceError;
+
+	/* Furthest the drawn arc can be from the real arc on screen in pixels. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.1", UIMin = "0.25", UIMax = "10.0"))
+	float teleportArcPixelError;
+
+	/* Pixels per degree of the headset display, used to turn the pixel error into cm at each distance from the camera. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1.0", UIMin = "5.0", UIMax = "60.0"))
+	float teleportArcPixelsPerDegree;
+
+	/* Most segments the adaptive teleport arc can use for either the traces or the visuals. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "2", UIMin = "8", UIMax = "256"))
+	int teleportArcMaxSegments;
+
+	/* Number of segments the last teleport arc was sampled into for tracing. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportArcTraceSegments;
+
+	/* Number of segments the last teleport arc was drawn with. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportArcVisualSegments;
+
+	/* Step the teleport arc with a few long line traces and bisect the one that hits to find the landing. NOTE: Only used with synchronous or worker thread traces. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool refinedTeleportArc;
+
+	/* Number of line traces the refined teleport arc is stepped with before the hit is refined. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1", UIMin = "2", UIMax = "32"))
+	int teleportArcCoarseSegments;
+
+	/* Number of times the segment of the refined teleport arc that hit is halved. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0", UIMin = "0", UIMax = "12"))
+	int teleportArcRefineSteps;
+
+	/* Radius of the sphere swept into the landing of the refined teleport arc to make sure there is room, 0 to skip the sweep. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "10.0"))
+	float teleportArcClearanceRadius;
+
+	/* Re-use last frames arc segments and results when they have barely moved instead of re-tracing the whole arc. NOTE: Only used with synchronous traces. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool incrementalTeleportArc;
+
+	/* Distance either end of an arc segment can move before it is re-traced. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "5.0"))
+	float teleportArcRetraceTolerance;
+
+	/* Number of frames after which the whole teleport arc is re-traced so anything that has moved into it is found. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1", UIMin = "1", UIMax = "90"))
+	int teleportArcRefreshFrames;
+
+	/* Number of arc segment traces that have been skipped by re-using a previous result. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportTracesSaved;
+
+	/* Number of frames the whole teleport arc update was skipped as the hand had not moved. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportArcUpdatesSkipped;
+
+	/* Number of scene queries made to find the last teleport arc. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportArcTraceCount;
+
 	/* How far in any given direction will the end location of the teleport arc try to find a valid nav-mesh location. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "100.0", ClampMax = "0.0", UIMax = "100.0"))
 	float teleportSearchDistance;
 
+	/* Search for the nav-mesh with teleportMinSearchDistance first and only double it up to teleportSearchDistance when nothing is found. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool progressiveTeleportNavSearch;
+
+	/* First extent the progressive nav-mesh search tries in each direction. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1.0", UIMin = "1.0", UIMax = "100.0"))
+	float teleportMinSearchDistance;
+
+	/* Count the nav-mesh polys inside each extent searched into teleportNavPolysTested. NOTE: Counting is a query of its own so only use this to profile. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool debugTeleportNavPolys;
+
+	/* Number of nav-mesh polys inside the extents searched by the last teleport nav-mesh query, 0 if it was cached. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportNavPolysTested;
+
+	/* Cache nav-mesh projections of teleport locations so aiming at the same area doesn't query the nav-mesh again. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool useTeleportNavCache;
+
+	/* Number of teleport nav-mesh projections answered from the cache. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportNavCacheHits;
+
+	/* Number of teleport nav-mesh projections that had to query the nav-mesh. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportNavCacheMisses;
+
+	/* Snap the teleport location to any teleport anchor component the arc lands within the snap radius of. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool useTeleportAnchors;
+
+	/* Number of times the teleport arc has snapped to a teleport anchor. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportAnchorSnaps;
+
+	/* Check teleport locations against the baked teleport grid of each visible level before using the nav-mesh. NOTE: Levels without a baked grid always use the nav-mesh. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool useTeleportGrid;
+
+	/* Size of each cell when baking the teleport grids with VRMovement.BakeTeleportGrids. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "5.0", UIMin = "10.0", UIMax = "100.0"))
+	float teleportGridCellSize;
+
+	/* Number of teleport locations answered by the baked teleport grids. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportGridHits;
+
+	/* Number of teleport locations in dynamic or un-baked areas that had to use the nav-mesh. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportGridFallbacks;
+
+	/* March the teleport arc through a voxel grid of the static collision around the player first and only trace the segments that could hit something.
+	 * NOTE: Used by the plain, refined and incremental arcs but not the asynchronous trace mode, which issues every segment before the grid could be checked.
+	 *       The grid is built teleportOccupancyBuildBudget at a time so arcs are traced in full until it is ready. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool useTeleportOccupancy;
+
+	/* Size of each voxel of the teleport occupancy grid. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "10.0", UIMin = "25.0", UIMax = "200.0"))
+	float teleportOccupancyVoxelSize;
+
+	/* Half size of the area around the player the teleport occupancy grid covers, it is rebuilt when the player moves over half of this from its center. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	FVector teleportOccupancyExtent;
+
+	/* Milliseconds each frame can spend building the teleport occupancy grid. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "0.1", UIMax = "5.0"))
+	float teleportOccupancyBuildBudget;
+
+	/* Milliseconds the teleport occupancy grid last took to build, summed over every frame it was built across. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	float teleportOccupancyBuildTime;
+
+	/* Number of segments of the last teleport arc that the occupancy grid showed were empty. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int teleportOccupancySkipped;
+
+	/* Start loading streaming levels and textures around a valid teleport location once it has been held for teleportPrewarmFrames. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool prewarmTeleportDestination;
+
+	/* Number of frames the valid teleport location has to stay within teleportPrewarmTolerance before it is warmed. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1", UIMin = "1", UIMax = "30"))
+	int teleportPrewarmFrames;
+
+	/* Distance the valid teleport location can move and still count as the same destination. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "10.0", UIMax = "200.0"))
+	float teleportPrewarmTolerance;
+
+	/* Distance around the destination that streaming volumes are warmed within. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "100.0", UIMax = "5000.0"))
+	float teleportPrewarmRadius;
+
+	/* Number of frames after teleporting that are timed for the post teleport frame time stats. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "1", UIMin = "1", UIMax = "60"))
+	int postTeleportSampleFrames;
+
+	/* Longest frame in milliseconds after the last teleport. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	float postTeleportFrameTime;
+
+	/* Average of the longest frame after each teleport to a warmed destination. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	float postTeleportFrameTimeWarm;
+
+	/* Average of the longest frame after each teleport to a destination that wasn't warmed. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	float postTeleportFrameTimeCold;
+
+	/* Run the jobs in the worlds teleport blackout queue while the camera is faded out for a teleport. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
+	bool useBlackoutQueue;
+
+	/* Milliseconds each faded out frame can spend running blackout jobs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", UIMin = "1.0", UIMax = "30.0"))
+	float blackoutWorkBudget;
+
+	/* How faded out the camera has to be before blackout jobs are ran, 1 is fully faded. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport", meta = (ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.5", UIMax = "1.0"))
+	float blackoutFadeThreshold;
+
+	/* Add a blackout job that finishes purging unreachable objects after a garbage collection. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement|Teleport")
+	bool blackoutPurgeGarbage;
+
+	/* Add a blackout job that processes pending async package loads, such as streaming levels. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement|Teleport")
+	bool blackoutProcessLoading;
+
+	/* Milliseconds spent running blackout jobs in the last faded out frame they were ran in. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	float blackoutWorkTime;
+
+	/* Number of blackout jobs that have been ran. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|Teleport|Stats")
+	int blackoutJobsRun;
+
+	/* Called when the player lands on or leaves the ground in the walking movement modes, the capsule simulates physics while off the ground. */
+	UPROPERTY(BlueprintAssignable, Category = "Movement|WalkingMovement")
+	FVRGroundStateChanged onGroundStateChanged;
+
+	/* Move the capsule with kinematic sweeps, steps and analytic gravity in the SpeedRamp, Joystick and SwingingArms modes instead of simulating physics while it falls. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement")
+	bool kinematicCapsule;
+
+	/* Tallest ledge the kinematic capsule can step up, also the furthest it is snapped down onto the floor while walking. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement", meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "60.0"))
+	float maxStepHeight;
+
+	/* Step the kinematic mover at locomotionStepRate and show the room between the last two steps, so walking is the same at any frame rate.
+	 * NOTE: Only the room is offset to where it would be between the steps, the capsule and its collision always stay where the last step left them. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement")
+	bool fixedStepLocomotion;
+
+	/* Kinematic mover steps per second when fixedStepLocomotion is set. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement", meta = (ClampMin = "10.0", UIMin = "30.0", UIMax = "240.0"))
+	float locomotionStepRate;
+
+	/* Most kinematic mover steps in one frame, time past this is dropped rather than letting a long frame make the next one longer. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement", meta = (ClampMin = "1", UIMin = "1", UIMax = "10"))
+	int maxLocomotionSteps;
+
+	/* Walk along the nav-mesh wherever there is one under the feet instead of sweeping the capsule, falling back to the kinematic mover off of it.
+	 * NOTE: Only used with kinematicCapsule. The player can't walk off the edge of the nav-mesh and only collides with what the nav-mesh knows about. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement")
+	bool navMeshWalking;
+
+	/* Keep the static primitives around the kinematic capsule and sweep against them directly, with only movable bodies going through the scene. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement")
+	bool useLocalCollisionCache;
+
+	/* Distance around the capsules cell that static primitives are cached from. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement", meta = (ClampMin = "50.0", UIMin = "100.0", UIMax = "1000.0"))
+	float localCollisionRadius;
+
+	/* Size of the cells the local collision cache is refreshed when the capsule moves between. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement", meta = (ClampMin = "10.0", UIMin = "50.0", UIMax = "500.0"))
+	float localCollisionCellSize;
+
+	/* Number of times the local collision cache has been refreshed. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|WalkingMovement|Stats")
+	int localCollisionRebuilds;
+
+	/* Number of static primitives in the local collision cache. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|WalkingMovement|Stats")
+	int localCollisionPrimitives;
+
+	/* Number of nav-mesh raycasts and projections made while walking on the nav-mesh. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|WalkingMovement|Stats")
+	int navWalkingQueries;
+
+	/* Number of floor traces made to find whether the player is on the ground. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|WalkingMovement|Stats")
+	int groundTraces;
+
+	/* Number of frames the ground state was kept without tracing because nothing had moved. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement|WalkingMovement|Stats")
+	int groundTracesSkipped;
+
 	/* Move direction is relative to the camera where as if this is false move direction will be relative to world. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|WalkingMovement")
 	bool cameraMoveDirection;
@@ -196,6 +527,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|SwingingArms", meta = (ClampMin = "0.0", ClampMax = "30.0", UIMin = "0.0", UIMax = "30.0"))
 	float swingingArmsSpeed;
 
+	/* Fit the swing speed through the moving controllers tracking space position over the last controllerSampleFrames frames, instead of using one world space delta per frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|SwingingArms")
+	bool useControllerSampler;
+
+	/* Number of frames of controller positions the swing speed is fitted through when useControllerSampler is set. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|SwingingArms", meta = (ClampMin = "2", UIMin = "2", UIMax = "30"))
+	int controllerSampleFrames;
+
+	/* Swing speed in cm/s that gives the full swinging arms speed scalar when useControllerSampler is set. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|SwingingArms", meta = (ClampMin = "1.0", UIMin = "100.0", UIMax = "3000.0"))
+	float swingingArmsFullSpeed;
+
 	/* Swinging arms speed scalar. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Teleport")
 	bool requiresNavMesh;
@@ -213,10 +556,24 @@ public:
 
 private:
 
+	FVRGroundTracker groundTracker; /* Whether the capsule is standing on anything, only traced for when something has moved. */
+	FCollisionQueryParams groundQueryParams;
+	FVRKinematicMover kinematicMover; /* Moves the capsule when kinematicCapsule is set. */
+	FVRLocalCollisionCache localCollision; /* Static primitives around the capsule when useLocalCollisionCache is set. */
+	FVRNavWalker navWalker; /* Moves the feet along the nav-mesh when navMeshWalking is set. */
+	FVRFixedStep locomotionStep;
+	FVector locomotionPreviousLocation; /* Capsule location before and after the last fixed step, the room is shown between them. */
+	FVector locomotionLocation; /* Where the capsule was left by the last fixed step, anything else means it has been moved by something other than the mover. */
+	FVector locomotionRenderOffset; /* World offset the room is shown at to place it between the last two steps. */
+	FVector locomotionSceneLocation; /* Relative location of the room without the render offset. */
+	FVector locomotionRenderSceneLocation; /* Relative location of the room with the offset added, anything else means the room has been placed by something else since. */
+	bool locomotionStateValid;
 	bool firstMove;// Used to determine the first frame of movement.
 	bool inAir;// Is the player currently in the air.
 	FVector originalMovementLocation;
 	FVector lastMovementLocation;
+	FVRControllerSampler controllerSampler; /* Last few positions of the moving controller for swinging arms when useControllerSampler is set. */
+	FVector swingingArmsVelocity; /* Swing velocity fitted through the sampled positions. */
 
 	/////////////////////////////////////////////////
 	//			    Teleporting Vars.			   //
@@ -227,15 +584,80 @@ private:
 	float teleportWidth;
 	FVector lastValidTeleportLocation;
 	FRotator teleportRotation;
-	TArray<class USplineMeshComponent*> splineMeshes;
+	TArray<FVector> teleportArcPoints; /* World space points along the current arc, kept between frames to avoid re-allocating. */
+	TArray<float> teleportArcTimes; /* Flight time of each point in teleportArcPoints. */
+	TArray<FVector> teleportArcVisualPoints; /* Points the current arc is drawn with when it is re-sampled for display. */
+	TArray<float> teleportArcVisualTimes;
+	FTeleportArcParams teleportArcParams; /* Launch values of the arc in teleportArcPoints. */
+	float teleportArcEndTime; /* Flight time the arc in teleportArcPoints ends at, negative if it wasn't found by the analytic solver. */
+	TArray<FVector> pendingArcPoints; /* Arc points the pending async segment traces were issued for. */
+	FTeleportArcParams pendingArcParams;
+	FTeleportArcTraceCache teleportArcCache; /* Segments and results of the last synchronously traced arc. */
+	FTeleportNavCache teleportNavCache; /* Nav-mesh projections of previous teleport locations. */
+	FTeleportValidityGrids teleportGrids; /* Memory mapped teleport grids of the visible levels. */
+	FTeleportOccupancyGrid teleportOccupancy; /* Static collision around teleportOccupancyCenter. */
+	FVector teleportOccupancyCenter;
+	bool teleportOccupancyDirty; /* Start building a new occupancy grid. */
+	FTeleportOccupancyGrid teleportOccupancyPending; /* Grid being built a slice at a time, swapped in for teleportOccupancy once it is done. */
+	FVector teleportOccupancyPendingCenter;
+	double teleportOccupancyPendingTime; /* Seconds spent building the pending grid so far. */
+	int teleportOccupancyPendingTests;
+	FDelegateHandle levelAddedHandle, levelRemovedHandle;
+	FTeleportPrewarmer teleportPrewarmer; /* Loads what the held teleport destination needs before the player gets there. */
+	FVector teleportPrewarmCandidate; /* Valid teleport location being held, warmed once teleportPrewarmStableFrames reaches teleportPrewarmFrames. */
+	int teleportPrewarmStableFrames;
+	int postTeleportFramesLeft; /* Frames left to time after the last teleport. */
+	bool postTeleportWarm; /* Was the destination of the last teleport warmed. */
+	int postTeleportWarmCount; /* Number of teleports averaged into postTeleportFrameTimeWarm and postTeleportFrameTimeCold. */
+	int postTeleportColdCount;
+	TArray<int32> blackoutJobs; /* Handles of the jobs this actor added to the blackout queue. */
+	bool blackoutDrained; /* Were blackout jobs ran last frame, that frames time is left out of the post teleport stats. */
+	FCollisionQueryParams teleportQueryParams; /* Params shared by every teleport trace, only rebuilt when movement is setup. */
+	TArray<AActor*> teleportIgnoredActors; /* Actors teleportQueryParams ignores, for queries that take an actor list. */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> teleportIgnoredComponents; /* Held props teleportQueryParams ignores. */
+	FTransform lastTeleportArcTransform; /* Movement target transform the current arc was created from. */
+	bool teleportArcLanded; /* Did the current arc hit anything. */
+	bool teleportAnchorSnapped; /* Has the current arc snapped to a teleport anchor. */
+	bool teleportAnchorSetsRotation; /* Should the player face teleportAnchorRotation after teleporting to the snapped anchor. */
+	FRotator teleportAnchorRotation;
+	TArray<FTraceHandle> pendingArcTraces; /* Async segment traces issued last frame, one per segment of pendingArcPoints. */
+	FTraceHandle pendingFloorTrace; /* Async floor trace issued last frame under pendingFloorLocation. */
+	FVector pendingFloorLocation;
+	FVector asyncFloorErrorLocation; /* Nav-mesh location the last resolved async floor trace was made from. */
+	float asyncFloorError; /* Height difference between the nav-mesh and the floor found by the last resolved async floor trace. */
+	bool hasAsyncFloorError;
+	FGraphEventRef teleportAimTask; /* Task finding and validating the arc from teleportAimTransform on a worker thread. */
+	FTransform teleportAimTransform; /* Movement target transform the teleport aim task was started with. */
+	AVRHand* teleportAimHand; /* Hand the teleport aim task was started for. */
+	FHitResult teleportAimHit; /* Results of the finished teleport aim task. */
+	FVector teleportAimLocation;
+	bool teleportAimLanded;
+	bool teleportAimValid;
+	bool teleportAimEvaluated; /* Has the teleport aim task finished this frame. */
+	bool teleportAimReused; /* Was the last arc kept this frame instead of starting a teleport aim task. */
+	const ANavigationData* teleportAimNavData; /* Nav data and filter the teleport aim task validates against, found on the game thread. */
+	FSharedConstNavQueryFilter teleportAimNavFilter;
+	int teleportAimPolysTested; /* Nav-mesh polys counted by the last validation, copied into teleportNavPolysTested on the game thread. */
+	int teleportAimArcTraceCount; /* Arc counters written by the last PredictTeleportArc, copied into the teleport arc stats on the game thread by UpdateTeleportArcStats. */
+	int teleportAimArcTraceSegments;
+	int teleportAimOccupancySkipped;
+	int teleportAimTracesSaved;
+
+	/* Material of each teleport mesh slot before setup and for a valid and invalid location, in the order of GetTeleportMeshes. */
+	UPROPERTY(Transient)
+	TArray<UMaterialInterface*> originalTeleportMaterials;
+	UPROPERTY(Transient)
+	TArray<UMaterialInterface*> validTeleportMaterials;
+	UPROPERTY(Transient)
+	TArray<UMaterialInterface*> invalidTeleportMaterials;
+	int teleportMaterialState; /* 1 if the valid materials are applied, 0 if the invalid ones are, -1 before either. */
 
 	/////////////////////////////////////////////////
 	//			     Vignette Vars.			       //
 	/////////////////////////////////////////////////
 
 	UMaterialInstanceDynamic* vignetteMAT;
-	float lastVignetteOpacity;
-	FTimerHandle vignetteTimer;
+	FVRVignetteDriver vignetteDriver; /* Fades vignetteMAT once per frame. */
 	bool canApplyVignette;
 
 	/////////////////////////////////////////////////
@@ -255,6 +677,9 @@ public:
 	/* Frame. */
 	virtual void Tick(float DeltaTime) override;
 
+	/* Level exit. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/////////////////////////////////////////////////
 	//		  Movement or Other Functions.		   //
 	/////////////////////////////////////////////////
@@ -263,6 +688,25 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetupMovement(AVRPawn* playerPawn, bool dev = false);
 
+	/* Pass the movement capsules sweep and physics hits on to the ground tracker. */
+	UFUNCTION()
+	void OnCapsuleHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	/* Update the ground state and enable or disable the capsules physics when the player lands or leaves the ground. */
+	void UpdateGroundState();
+
+	/* Move the capsule from this frames movement input with the kinematic mover. */
+	void UpdateKinematicMovement(float DeltaTime);
+
+	/* Move the capsule for one step, along the nav-mesh if navData is given and the feet are on it, otherwise with the kinematic mover.
+	 * @Param desiredVelocity, Horizontal velocity to accelerate towards.
+	 * @Param deltaTime, Seconds to move for.
+	 * @Param navData, Nav-mesh to walk on, null to always use the kinematic mover. */
+	void StepLocomotion(const FVector& desiredVelocity, float deltaTime, const ANavigationData* navData);
+
+	/* Put the room back to its location without the fixed step render offset, unless it has been placed by something else since the offset was written. */
+	void RemoveLocomotionRenderOffset();
+
 	/* Function to enable/disable the capsule collisions physics for gravity. */
 	void EnableCapsule(bool enable = true);
 
@@ -272,12 +716,17 @@ public:
 	/* Function to update while the teleport button is down. */
 	void UpdateControllerMovement(AVRHand* movementHand);
 
-	/* Function to interpolate vignette opacity back to 1.0 (invisible). */
+	/* Move the capsule back under the camera with a single sweep and place the room so the camera lands over the capsules new location.
+	 * NOTE: The capsules transform propagation and overlaps are deferred until the room has been placed, so everything attached only updates once.
+	 *       The room only moves when the sweep is blocked, otherwise the camera is already over the capsule. */
+	void RecenterCapsule();
+
+	/* Function to fade the vignette back to 1.0 (invisible) until movement is fast enough to apply it again. */
 	UFUNCTION(BlueprintCallable, Category = "WalkingMovement")
 	void ResetVignette();
 
-	/* Interpolates the vignettes opacity value stored in the vignetteMAT variable to a specified target. */
-	void LerpVignette(float target);
+	/* Fade the vignette towards visible while moving above minVignetteSpeed and invisible otherwise, called once per frame. */
+	void UpdateVignette(float DeltaTime);
 
 	/////////////////////////////////////////////////
 	//			Teleporting Functions.			   //
@@ -289,13 +738,105 @@ public:
 	/* Returns weather or not the teleport spline has hit anything, also updated outLocation. */
 	bool CreateTeleportSpline(FTransform startTransform, FVector& outLocation);
 
-	/* Removes all spline meshes and hides any teleport components. */
+	/* Find the teleport arc fired from start in direction and store its points in teleportArcPoints.
+	 * @Param start, World location to fire the arc from.
+	 * @Param direction, Normalized direction to fire the arc in.
+	 * @Param analytic, Use the closed form arc solver, otherwise use the blueprint projectile path prediction.
+	 * @Param @Output outHit, The first blocking hit along the arc.
+	 * @Return true if the arc hit anything.
+	 * NOTE: Doesn't update the stats so it can run from the teleport aim task, see UpdateTeleportArcStats. */
+	bool PredictTeleportArc(const FVector& start, const FVector& direction, bool analytic, FHitResult& outHit);
+
+	/* Start finding and validating the teleport arc of movementHand on a worker thread, called from the pawns pre physics tick. NOTE: Only used with the worker thread trace mode. */
+	void LaunchTeleportAim(AVRHand* movementHand);
+
+	/* Find and validate the arc from teleportAimTransform, ran by the teleport aim task. */
+	void EvaluateTeleportAim();
+
+	/* Wait for the teleport aim task to finish if one is running. */
+	void WaitForTeleportAim();
+
+	/* Returns true if the movement target has barely moved since the current arc was created so the whole arc and its result can be kept. */
+	bool CanReuseTeleportArc(const FTransform& startTransform);
+
+	/* Forget any async teleport traces that are still waiting to be used. */
+	void ResetAsyncTeleportTraces();
+
+	/* Time each teleport arc solver from the current movement target and log the results and how far their landings are from the projectile path.
+	 * @Param iterations, Number of arcs to solve with each solver. */
+	void BenchmarkTeleportArc(int iterations);
+
+	/* Bake the teleport grid of every visible level from the nav-mesh and floors around the player. NOTE: Run in PIE with the nav-mesh built.
+	 * @Param cellSize, Size of each grid cell, uses teleportGridCellSize if 0. */
+	void BakeTeleportGrids(float cellSize = 0.0f);
+
+	/* Hides the teleport arc and any teleport components. */
 	void DestroyTeleportSpline();
 
-	/* Check if area is a valid teleport location. */
+	/* Fill the teleport spline and rebuild the arc mesh from the points in teleportArcPoints. */
+	void UpdateTeleportArc();
+
+	/* Build part of a new teleport occupancy grid around the player if it is needed, the grid is swapped in once it is done. */
+	void UpdateTeleportOccupancy();
+
+	/* Called when a level is added to or removed from any world to rebuild the occupancy grid. */
+	void OnLevelsChanged(ULevel* level, UWorld* world);
+
+	/* Warm the valid teleport location once it has been held for long enough, called after the arc is updated. */
+	void UpdateTeleportPrewarm();
+
+	/* Time the frames after a teleport and log them once postTeleportSampleFrames have passed. */
+	void UpdatePostTeleportStats(float DeltaTime);
+
+	/* Add this actors own jobs to the worlds blackout queue if they haven't been already. */
+	void SetupBlackoutJobs();
+
+	/* Run blackout jobs if the camera is faded out for a teleport. */
+	void UpdateBlackout();
+
+	/* Build teleportQueryParams and teleportIgnoredActors for the current player. */
+	void SetupTeleportQuery();
+
+	/* Stop or start the teleport arc from hitting a component, called by the hands when a prop is picked up or dropped.
+	 * NOTE: The component is added to the teleport query's ignored components, its own collision responses are left as they are.
+	 * @Param component, The component to ignore or stop ignoring.
+	 * @Param ignore, Ignore the component, otherwise let the arc hit it again. */
+	UFUNCTION(BlueprintCallable, Category = "Movement|Teleport")
+	void SetIgnoredByTeleport(UPrimitiveComponent* component, bool ignore);
+
+	/* Returns the number of segments to trace the given arc with. */
+	int GetTeleportArcTraceSegments(const FTeleportArcParams& arcParams) const;
+
+	/* Find the flight time the traced arc ended at from the hit on its last segment. */
+	void UpdateTeleportArcEndTime(bool hitFound, const FHitResult& hit);
+
+	/* Check if area is a valid teleport location. NOTE: Game thread only. */
 	bool ValidateTeleportLocation(FVector& location);
 
-	/* Change the materials of all the teleport meshes. */
+	/* Check if area is a valid teleport location against nav data and a filter found on the game thread, safe to run from the teleport aim task.
+	 * NOTE: Doesn't update the stats, see UpdateTeleportNavStats. */
+	bool ValidateTeleportLocation(FVector& location, const ANavigationData* navData, FSharedConstNavQueryFilter navFilter);
+
+	/* Returns the nav data for the players nav agent. NOTE: Game thread only. */
+	ANavigationData* GetTeleportNavData();
+
+	/* Copy the counters of the last PredictTeleportArc into the teleport arc stats. NOTE: Game thread only. */
+	void UpdateTeleportArcStats();
+
+	/* Copy the teleport grid and nav cache counters into their stats. */
+	void UpdateTeleportNavStats();
+
+	/* Called by the navigation system when a nav-mesh rebuild finishes to drop any cached projections in rebuilt tiles. */
+	UFUNCTION()
+	void OnNavigationRebuilt(ANavigationData* navData);
+
+	/* Returns every mesh that shows the teleport state. */
+	void GetTeleportMeshes(TArray<UMeshComponent*, TInlineAllocator<4>>& outMeshes) const;
+
+	/* Create the shared valid and invalid materials for each teleport mesh slot, meshes using the same material share the same pair. */
+	void SetupTeleportMaterials();
+
+	/* Swap the materials of all the teleport meshes to the valid or invalid ones, does nothing if they are already applied. */
 	void UpdateTeleportMaterials(bool valid);
 
 	/* Fade the camera out -> teleport -> fade back in. */
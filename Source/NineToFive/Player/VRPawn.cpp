@@ -165,6 +165,9 @@ void AVRPawn::Tick(float DeltaTime)
 	// Update the hands tick function from this class. PRE PHYSICS...
 	if (leftHand && leftHand->active) leftHand->Tick(DeltaTime);
 	if (rightHand && rightHand->active) rightHand->Tick(DeltaTime);
+
+	// Start finding the teleport arc on a worker thread now the hands have moved, it is used in PostUpdateTick.
+	if (movingHand && vrMovement) vrMovement->LaunchTeleportAim(movingHand);
 }
 
 void AVRPawn::PostUpdateTick(float DeltaTime)
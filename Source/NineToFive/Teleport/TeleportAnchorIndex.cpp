@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportAnchorIndex.h"
+#include "CustomComponent/TeleportAnchorComponent.h"
+#include "Engine/World.h"
+
+TMap<TWeakObjectPtr<UWorld>, TUniquePtr<FTeleportAnchorIndex>> FTeleportAnchorIndex::worldIndices;
+
+FTeleportAnchorIndex::FTeleportAnchorIndex()
+{
+	cellSize = 100.0f;
+	maxSnapRadius = 0.0f;
+}
+
+FTeleportAnchorIndex* FTeleportAnchorIndex::Get(UWorld* world, bool create)
+{
+	if (!world) return nullptr;
+	if (TUniquePtr<FTeleportAnchorIndex>* index = worldIndices.Find(world)) return index->Get();
+	if (!create) return nullptr;
+
+	// Drop the indices of any worlds that have been destroyed before adding a new one.
+	for (auto indexIt = worldIndices.CreateIterator(); indexIt; ++indexIt)
+	{
+		if (!indexIt.Key().IsValid()) indexIt.RemoveCurrent();
+	}
+	return worldIndices.Add(world, MakeUnique<FTeleportAnchorIndex>()).Get();
+}
+
+void FTeleportAnchorIndex::Release(UWorld* world)
+{
+	if (!world) return;
+	TUniquePtr<FTeleportAnchorIndex>* index = worldIndices.Find(world);
+	if (index && (*index)->anchors.Num() == 0) worldIndices.Remove(world);
+}
+
+FIntVector FTeleportAnchorIndex::GetCell(const FVector& location) const
+{
+	return FIntVector(FMath::FloorToInt(location.X / cellSize), FMath::FloorToInt(location.Y / cellSize), FMath::FloorToInt(location.Z / cellSize));
+}
+
+void FTeleportAnchorIndex::ReadAnchor(UTeleportAnchorComponent* component, FTeleportAnchor& outAnchor) const
+{
+	outAnchor.location = component->GetComponentLocation();
+	outAnchor.rotation = FRotator(0.0f, component->GetComponentRotation().Yaw, 0.0f);
+	outAnchor.snapRadius = component->snapRadius;
+	outAnchor.setRotation = component->setRotation;
+	outAnchor.component = component;
+}
+
+void FTeleportAnchorIndex::Rebuild()
+{
+	cells.Reset();
+	for (int i = 0; i < anchors.Num(); i++)
+	{
+		cells.FindOrAdd(GetCell(anchors[i].location)).Add(i);
+	}
+}
+
+void FTeleportAnchorIndex::Add(UTeleportAnchorComponent* component)
+{
+	if (component->anchorIndex != INDEX_NONE) return;
+
+	component->anchorIndex = anchors.AddUninitialized();
+	FTeleportAnchor& anchor = anchors[component->anchorIndex];
+	ReadAnchor(component, anchor);
+
+	// Grow the cells if this anchor snaps further than they allow for.
+	maxSnapRadius = FMath::Max(maxSnapRadius, anchor.snapRadius);
+	if (maxSnapRadius * 2.0f > cellSize)
+	{
+		cellSize = maxSnapRadius * 2.0f;
+		Rebuild();
+	}
+	else cells.FindOrAdd(GetCell(anchor.location)).Add(component->anchorIndex);
+}
+
+bool FTeleportAnchorIndex::Remove(UTeleportAnchorComponent* component)
+{
+	int index = component->anchorIndex;
+	if (index == INDEX_NONE || !anchors.IsValidIndex(index) || anchors[index].component != component) return anchors.Num() == 0;
+
+	// Remove it from its cell.
+	FIntVector cell = GetCell(anchors[index].location);
+	if (TArray<int32>* cellAnchors = cells.Find(cell))
+	{
+		cellAnchors->RemoveSingleSwap(index, false);
+		if (cellAnchors->Num() == 0) cells.Remove(cell);
+	}
+
+	// Move the last anchor into the gap and point its cell at the new index.
+	int last = anchors.Num() - 1;
+	if (index != last)
+	{
+		if (TArray<int32>* lastCellAnchors = cells.Find(GetCell(anchors[last].location)))
+		{
+			int32* lastEntry = lastCellAnchors->FindByKey(last);
+			if (lastEntry) *lastEntry = index;
+		}
+		anchors[last].component->anchorIndex = index;
+	}
+	anchors.RemoveAtSwap(index, 1, false);
+	component->anchorIndex = INDEX_NONE;
+
+	return anchors.Num() == 0;
+}
+
+void FTeleportAnchorIndex::Update(UTeleportAnchorComponent* component)
+{
+	int index = component->anchorIndex;
+	if (index == INDEX_NONE || !anchors.IsValidIndex(index) || anchors[index].component != component) return;
+
+	FTeleportAnchor& anchor = anchors[index];
+	FIntVector oldCell = GetCell(anchor.location);
+	ReadAnchor(component, anchor);
+
+	if (anchor.snapRadius * 2.0f > cellSize)
+	{
+		maxSnapRadius = anchor.snapRadius;
+		cellSize = maxSnapRadius * 2.0f;
+		Rebuild();
+		return;
+	}
+	maxSnapRadius = FMath::Max(maxSnapRadius, anchor.snapRadius);
+
+	// Only touch the cells if the anchor has moved into a different one.
+	FIntVector newCell = GetCell(anchor.location);
+	if (newCell != oldCell)
+	{
+		if (TArray<int32>* oldCellAnchors = cells.Find(oldCell))
+		{
+			oldCellAnchors->RemoveSingleSwap(index, false);
+			if (oldCellAnchors->Num() == 0) cells.Remove(oldCell);
+		}
+		cells.FindOrAdd(newCell).Add(index);
+	}
+}
+
+const FTeleportAnchor* FTeleportAnchorIndex::FindNearest(const FVector& location) const
+{
+	// Cells are at least twice the largest snap radius so the box around location only covers up to two cells on each axis.
+	FIntVector minCell = GetCell(location - FVector(maxSnapRadius));
+	FIntVector maxCell = GetCell(location + FVector(maxSnapRadius));
+	const FTeleportAnchor* nearest = nullptr;
+	float nearestDistSquared = MAX_flt;
+	for (int x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			for (int z = minCell.Z; z <= maxCell.Z; z++)
+			{
+				const TArray<int32>* cellAnchors = cells.Find(FIntVector(x, y, z));
+				if (!cellAnchors) continue;
+				for (int32 index : *cellAnchors)
+				{
+					const FTeleportAnchor& anchor = anchors[index];
+					float distSquared = FVector::DistSquared(anchor.location, location);
+					if (distSquared < nearestDistSquared && distSquared <= anchor.snapRadius * anchor.snapRadius)
+					{
+						nearest = &anchor;
+						nearestDistSquared = distSquared;
+					}
+				}
+			}
+		}
+	}
+	return nearest;
+}
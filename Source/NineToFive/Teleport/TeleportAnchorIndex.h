@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+
+/* Declare classes used. */
+class UWorld;
+class UTeleportAnchorComponent;
+
+/* Snap location and rotation of a teleport anchor, copied from the component when it is added or moved. */
+struct FTeleportAnchor
+{
+	FVector location;
+	FRotator rotation;
+	float snapRadius;
+	bool setRotation;
+	UTeleportAnchorComponent* component;
+};
+
+/* Uniform grid of every teleport anchor in a world so the nearest to the teleport arcs landing is found by checking at most eight cells.
+ * NOTE: Anchors are stored densely and cells only hold indices so moving an anchor within its cell is a copy and moving between cells is two small array edits.
+ *       Only used on the game thread. */
+class NINETOFIVE_API FTeleportAnchorIndex
+{
+private:
+
+	TArray<FTeleportAnchor> anchors;
+	TMap<FIntVector, TArray<int32>> cells;
+	float cellSize; /* Always at least twice the largest snap radius so a query covers no more than two cells along each axis. */
+	float maxSnapRadius;
+
+	/* Every index with at least one anchor. */
+	static TMap<TWeakObjectPtr<UWorld>, TUniquePtr<FTeleportAnchorIndex>> worldIndices;
+
+	/* Returns the cell containing location. */
+	FIntVector GetCell(const FVector& location) const;
+
+	/* Copy the anchors values from its component. */
+	void ReadAnchor(UTeleportAnchorComponent* component, FTeleportAnchor& outAnchor) const;
+
+	/* Put every anchor back into cells of the current cell size. */
+	void Rebuild();
+
+public:
+
+	/* Constructor. */
+	FTeleportAnchorIndex();
+
+	/* Returns the anchor index of a world.
+	 * @Param world, The world to get the index of.
+	 * @Param create, Create the index if the world doesn't have one yet.
+	 * @Return null if the world has no index and create is false. */
+	static FTeleportAnchorIndex* Get(UWorld* world, bool create);
+
+	/* Add an anchor, does nothing if it is already added. */
+	void Add(UTeleportAnchorComponent* component);
+
+	/* Destroy the index of a world if it has no anchors left.
+	 * NOTE: Must not be called from inside the index itself, the caller of Remove releases it instead. */
+	static void Release(UWorld* world);
+
+	/* Remove an anchor, does nothing if it isn't in this index.
+	 * @Return true if the index has no anchors left and can be released. */
+	bool Remove(UTeleportAnchorComponent* component);
+
+	/* Re-read an anchors location, rotation and radius after it has changed. */
+	void Update(UTeleportAnchorComponent* component);
+
+	/* Find the closest anchor whose snap radius contains location.
+	 * @Return null if location isn't within any anchors snap radius. NOTE: Only valid until the index is next changed. */
+	const FTeleportAnchor* FindNearest(const FVector& location) const;
+
+	/* Returns the number of anchors in the index. */
+	int Num() const { return anchors.Num(); }
+};
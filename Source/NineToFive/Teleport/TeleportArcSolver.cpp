@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportArcSolver.h"
+#include "Teleport/TeleportOccupancyGrid.h"
+#include "Engine/World.h"
+
+FVector FTeleportArcSolver::GetPointAtTime(const FTeleportArcParams& params, float time)
+{
+	return params.start + params.velocity * time + FVector(0.0f, 0.0f, 0.5f * params.gravityZ * time * time);
+}
+
+void FTeleportArcSolver::SamplePoints(const FTeleportArcParams& params, const float* times, int numTimes, FVector* outPoints)
+{
+	// Splat each component of the launch values across a register so four times can be evaluated at once.
+	const VectorRegister startX = VectorSetFloat1(params.start.X);
+	const VectorRegister startY = VectorSetFloat1(params.start.Y);
+	const VectorRegister startZ = VectorSetFloat1(params.start.Z);
+	const VectorRegister velocityX = VectorSetFloat1(params.velocity.X);
+	const VectorRegister velocityY = VectorSetFloat1(params.velocity.Y);
+	const VectorRegister velocityZ = VectorSetFloat1(params.velocity.Z);
+	const VectorRegister halfGravity = VectorSetFloat1(0.5f * params.gravityZ);
+
+	MS_ALIGN(16) float xs[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float ys[4] GCC_ALIGN(16);
+	MS_ALIGN(16) float zs[4] GCC_ALIGN(16);
+
+	int i = 0;
+	for (; i + 4 <= numTimes; i += 4)
+	{
+		const VectorRegister time = VectorLoad(times + i);
+		VectorStoreAligned(VectorMultiplyAdd(velocityX, time, startX), xs);
+		VectorStoreAligned(VectorMultiplyAdd(velocityY, time, startY), ys);
+		VectorStoreAligned(VectorMultiplyAdd(halfGravity, VectorMultiply(time, time), VectorMultiplyAdd(velocityZ, time, startZ)), zs);
+
+		outPoints[i] = FVector(xs[0], ys[0], zs[0]);
+		outPoints[i + 1] = FVector(xs[1], ys[1], zs[1]);
+		outPoints[i + 2] = FVector(xs[2], ys[2], zs[2]);
+		outPoints[i + 3] = FVector(xs[3], ys[3], zs[3]);
+	}
+
+	// Evaluate any remaining points that don't fill a register.
+	for (; i < numTimes; i++)
+	{
+		outPoints[i] = GetPointAtTime(params, times[i]);
+	}
+}
+
+void FTeleportArcSolver::SampleUniform(const FTeleportArcParams& params, int numSegments, TArray<float>& outTimes, TArray<FVector>& outPoints)
+{
+	const int numPoints = FMath::Max(numSegments, 1) + 1;
+	const float timeStep = params.maxSimTime / (numPoints - 1);
+	outTimes.SetNumUninitialized(numPoints, false);
+	outPoints.SetNumUninitialized(numPoints, false);
+	for (int i = 0; i < numPoints; i++)
+	{
+		outTimes[i] = timeStep * i;
+	}
+	SamplePoints(params, outTimes.GetData(), numPoints, outPoints.GetData());
+}
+
+float FTeleportArcSolver::GetTimeStepForError(const FTeleportArcParams& params, float maxError)
+{
+	// A straight arc can be covered by a single segment.
+	float gravity = FMath::Abs(params.gravityZ);
+	if (gravity < KINDA_SMALL_NUMBER) return params.maxSimTime;
+	return FMath::Min(FMath::Sqrt(8.0f * FMath::Max(maxError, 0.0f) / gravity), params.maxSimTime);
+}
+
+void FTeleportArcSolver::SampleAdaptive(const FTeleportArcParams& params, float endTime, const FVector& viewLocation, float minError, float errorPerDistance, int maxSegments, TArray<float>& outTimes, TArray<FVector>& outPoints)
+{
+	// Step along the arc taking the longest step the error allowed at the current distance from the view permits.
+	const float minStep = endTime / FMath::Max(maxSegments, 1);
+	outTimes.Reset();
+	outTimes.Add(0.0f);
+	float time = 0.0f;
+	while (time < endTime)
+	{
+		float error = minError + errorPerDistance * FVector::Dist(GetPointAtTime(params, time), viewLocation);
+		time = FMath::Min(time + FMath::Max(GetTimeStepForError(params, error), minStep), endTime);
+		outTimes.Add(time);
+	}
+
+	outPoints.SetNumUninitialized(outTimes.Num(), false);
+	SamplePoints(params, outTimes.GetData(), outTimes.Num(), outPoints.GetData());
+}
+
+bool FTeleportArcSolver::TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, FHitResult& outHit, int& outTraceCount)
+{
+	outTraceCount = 0;
+	outHit.Init();
+	if (!world) return false;
+
+	// Segments are traced in order so nothing past the first hit is ever queried.
+	for (int i = 0; i < points.Num() - 1; i++)
+	{
+		outTraceCount++;
+		if (world->LineTraceSingleByChannel(outHit, points[i], points[i + 1], channel, queryParams))
+		{
+			// End the arc at the hit location.
+			points.SetNum(i + 2, false);
+			points[i + 1] = outHit.Location;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FTeleportArcSolver::TraceArcRefined(UWorld* world, const FTeleportArcParams& params, int numSegments, int refineSteps, float clearanceRadius, ECollisionChannel channel, const FCollisionQueryParams& queryParams,
+	TArray<float>& outTimes, TArray<FVector>& outPoints, FHitResult& outHit, float& outEndTime, int& outTraceCount, const FTeleportOccupancyGrid* occupancy, int* outSegmentsSkipped)
+{
+	SampleUniform(params, numSegments, outTimes, outPoints);
+	outEndTime = params.maxSimTime;
+	int segmentsSkipped = 0;
+	bool hitFound = occupancy ? occupancy->TraceArc(world, outPoints, channel, queryParams, outHit, outTraceCount, segmentsSkipped) : TraceArc(world, outPoints, channel, queryParams, outHit, outTraceCount);
+	if (outSegmentsSkipped) *outSegmentsSkipped = segmentsSkipped;
+	if (!hitFound) return false;
+
+	// The coarse segment cuts the corner of the arc, so bisect its flight time tracing the arc itself until the hit is pinned down.
+	const int hitSegment = outPoints.Num() - 2;
+	float lowTime = outTimes[hitSegment];
+	float highTime = outTimes[hitSegment + 1];
+	FVector lowPoint = outPoints[hitSegment];
+	outEndTime = FMath::Lerp(lowTime, highTime, outHit.Time);
+	FHitResult halfHit;
+	for (int i = 0; i < refineSteps; i++)
+	{
+		float midTime = (lowTime + highTime) * 0.5f;
+		FVector midPoint = GetPointAtTime(params, midTime);
+		outTraceCount++;
+		if (world->LineTraceSingleByChannel(halfHit, lowPoint, midPoint, channel, queryParams))
+		{
+			highTime = midTime;
+			outHit = halfHit;
+			outEndTime = FMath::Lerp(lowTime, midTime, halfHit.Time);
+		}
+		else
+		{
+			lowTime = midTime;
+			lowPoint = midPoint;
+		}
+	}
+
+	// The last half that hit may be longer than the final bracket so trace what's left of it, if the arc just misses an edge keep the coarse hit.
+	outTraceCount++;
+	if (world->LineTraceSingleByChannel(halfHit, lowPoint, GetPointAtTime(params, highTime), channel, queryParams))
+	{
+		outHit = halfHit;
+		outEndTime = FMath::Lerp(lowTime, highTime, halfHit.Time);
+	}
+
+	// Confirm there is room to land, anything else the sphere touches on the way in is hit first.
+	if (clearanceRadius > 0.0f)
+	{
+		outTraceCount++;
+		FHitResult clearanceHit;
+		if (world->SweepSingleByChannel(clearanceHit, lowPoint, outHit.Location, FQuat::Identity, channel, FCollisionShape::MakeSphere(clearanceRadius), queryParams)
+			&& clearanceHit.Component != outHit.Component)
+		{
+			outHit = clearanceHit;
+			outEndTime = FMath::Lerp(lowTime, outEndTime, clearanceHit.Time);
+		}
+	}
+
+	// End the arc at the refined hit.
+	outPoints.Last() = outHit.Location;
+	return true;
+}
+
+void FTeleportArcSolver::TraceArcAsync(UWorld* world, const TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, TArray<FTraceHandle>& outHandles)
+{
+	outHandles.Reset();
+	if (!world) return;
+
+	for (int i = 0; i < points.Num() - 1; i++)
+	{
+		outHandles.Add(world->AsyncLineTraceByChannel(EAsyncTraceType::Single, points[i], points[i + 1], channel, queryParams));
+	}
+}
+
+bool FTeleportArcSolver::ResolveArcAsync(UWorld* world, const TArray<FTraceHandle>& handles, TArray<FVector>& points, FHitResult& outHit, bool& outResolved)
+{
+	outResolved = false;
+	outHit.Init();
+	if (!world || handles.Num() != points.Num() - 1) return false;
+
+	// Walk the segment results in order so the earliest hit along the arc wins.
+	FTraceDatum segmentData;
+	for (int i = 0; i < handles.Num(); i++)
+	{
+		if (!world->QueryTraceData(handles[i], segmentData)) return false;
+		if (segmentData.OutHits.Num() > 0 && segmentData.OutHits[0].bBlockingHit)
+		{
+			outHit = segmentData.OutHits[0];
+			points.SetNum(i + 2, false);
+			points[i + 1] = outHit.Location;
+			outResolved = true;
+			return true;
+		}
+	}
+	outResolved = true;
+	return false;
+}
+
+void FTeleportArcTraceCache::Reset()
+{
+	tracedSegments = 0;
+	framesSinceFullTrace = 0;
+}
+
+bool FTeleportArcTraceCache::TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, float tolerance, int refreshFrames,
+	FHitResult& outHit, int& outTraceCount, int& outTracesSaved, const FTeleportOccupancyGrid* occupancy, int* outSegmentsSkipped)
+{
+	outTraceCount = 0;
+	outTracesSaved = 0;
+	if (outSegmentsSkipped) *outSegmentsSkipped = 0;
+	outHit.Init();
+	if (!world) return false;
+
+	// Every so often re-trace everything so anything that has moved into the arc is found.
+	bool canReuse = ++framesSinceFullTrace < refreshFrames;
+	if (!canReuse) framesSinceFullTrace = 0;
+
+	const int numSegments = points.Num() - 1;
+	const float toleranceSquared = tolerance * tolerance;
+	segmentStarts.SetNum(numSegments, false);
+	segmentEnds.SetNum(numSegments, false);
+	segmentHits.SetNum(numSegments, false);
+
+	// Ends are compared against where the segment was traced, not last frame, so slow drift still causes a re-trace.
+	int hitSegment = INDEX_NONE;
+	int emptySegments = INDEX_NONE;
+	TArray<FBox, TInlineAllocator<8>> dynamicBounds;
+	for (int i = 0; i < numSegments; i++)
+	{
+		bool reuse = canReuse && i < tracedSegments
+			&& FVector::DistSquared(points[i], segmentStarts[i]) <= toleranceSquared
+			&& FVector::DistSquared(points[i + 1], segmentEnds[i]) <= toleranceSquared;
+		if (reuse) outTracesSaved++;
+		else
+		{
+			// Only ask the occupancy grid once a segment actually needs re-tracing, the overlap for movable bodies is a query of its own.
+			if (occupancy && occupancy->IsBuilt() && emptySegments == INDEX_NONE)
+			{
+				int overlapCount = 0;
+				emptySegments = occupancy->FindEmptySegments(world, points, channel, queryParams, dynamicBounds, overlapCount);
+				outTraceCount += overlapCount;
+			}
+
+			if (i < emptySegments && FTeleportOccupancyGrid::CanSkipSegment(points[i], points[i + 1], dynamicBounds))
+			{
+				segmentHits[i].Init();
+				if (outSegmentsSkipped) (*outSegmentsSkipped)++;
+			}
+			else
+			{
+				outTraceCount++;
+				world->LineTraceSingleByChannel(segmentHits[i], points[i], points[i + 1], channel, queryParams);
+			}
+			segmentStarts[i] = points[i];
+			segmentEnds[i] = points[i + 1];
+		}
+
+		if (segmentHits[i].bBlockingHit)
+		{
+			hitSegment = i;
+			break;
+		}
+	}
+	tracedSegments = hitSegment == INDEX_NONE ? numSegments : hitSegment + 1;
+
+	// End the arc at the hit location.
+	if (hitSegment == INDEX_NONE) return false;
+	outHit = segmentHits[hitSegment];
+	points.SetNum(hitSegment + 2, false);
+	points[hitSegment + 1] = outHit.Location;
+	return true;
+}
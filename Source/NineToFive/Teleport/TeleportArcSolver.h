@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+
+/* Declare classes used. */
+class UWorld;
+class FTeleportOccupancyGrid;
+
+/* Launch values of a ballistic teleport arc. */
+struct FTeleportArcParams
+{
+	FVector start; /* World location the arc is fired from. */
+	FVector velocity; /* Launch velocity of the arc. */
+	float gravityZ; /* Gravity applied to the arc along the world Z axis. */
+	float maxSimTime; /* Time in seconds after which the arc ends if nothing is hit. */
+
+	FTeleportArcParams()
+		: start(FVector::ZeroVector), velocity(FVector::ZeroVector), gravityZ(0.0f), maxSimTime(0.0f)
+	{}
+};
+
+/* Closed form solver for the teleport arc. p(t) = start + velocity * t + 0.5 * gravity * t^2.
+ * NOTE: Points are evaluated four at a time with vector registers so the whole arc is sampled in one batch without stepping a simulation. */
+struct NINETOFIVE_API FTeleportArcSolver
+{
+	/* Returns the location on the arc at the given time. */
+	static FVector GetPointAtTime(const FTeleportArcParams& params, float time);
+
+	/* Evaluate the arc at each of the given times.
+	 * @Param params, The arc to evaluate.
+	 * @Param times, Array of numTimes times in seconds to evaluate.
+	 * @Param numTimes, Number of times and points.
+	 * @Param @Output outPoints, Array of at least numTimes points that is filled with the arc locations. */
+	static void SamplePoints(const FTeleportArcParams& params, const float* times, int numTimes, FVector* outPoints);
+
+	/* Fill outPoints with numSegments + 1 evenly spaced points from the start to the end of the arc.
+	 * NOTE: outTimes and outPoints are only re-allocated if they are too small. */
+	static void SampleUniform(const FTeleportArcParams& params, int numSegments, TArray<float>& outTimes, TArray<FVector>& outPoints);
+
+	/* Returns the longest time step whose straight segment stays within maxError of the arc.
+	 * NOTE: Only gravity bends the arc so the gap between a segment and the arc is at most |gravity| * step^2 / 8 wherever it is along the arc. */
+	static float GetTimeStepForError(const FTeleportArcParams& params, float maxError);
+
+	/* Fill outPoints from the start of the arc to endTime with steps that keep each segment within minError + errorPerDistance * its distance from viewLocation of the arc.
+	 * @Param params, The arc to sample.
+	 * @Param endTime, Time in seconds to end the arc at.
+	 * @Param viewLocation, Location the arc is viewed from.
+	 * @Param minError, Error allowed at the view location.
+	 * @Param errorPerDistance, Extra error allowed per unit of distance from the view location.
+	 * @Param maxSegments, The most segments to use, steps are never shorter than endTime / maxSegments.
+	 * NOTE: outTimes and outPoints are only re-allocated if they are too small. */
+	static void SampleAdaptive(const FTeleportArcParams& params, float endTime, const FVector& viewLocation, float minError, float errorPerDistance, int maxSegments, TArray<float>& outTimes, TArray<FVector>& outPoints);
+
+	/* Line trace each segment between consecutive points in order and stop at the first blocking hit.
+	 * @Param world, World to trace in.
+	 * @Param @Output points, The arc points, truncated to end at the hit location if something is hit.
+	 * @Param channel, Trace channel to use.
+	 * @Param queryParams, Query parameters including any ignored actors.
+	 * @Param @Output outHit, The first blocking hit along the arc.
+	 * @Param @Output outTraceCount, Number of scene queries made.
+	 * @Return true if anything was hit. */
+	static bool TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, FHitResult& outHit, int& outTraceCount);
+
+	/* Trace the arc with a few long line traces, then halve the flight time of the segment that hit until the hit is where the arc itself lands and confirm it with a single sphere sweep.
+	 * @Param params, The arc to trace.
+	 * @Param numSegments, Number of coarse segments to step the whole arc with.
+	 * @Param refineSteps, Number of times to halve the segment that hit.
+	 * @Param clearanceRadius, Radius of the sphere swept into the landing location, 0 to skip the sweep.
+	 * @Param @Output outTimes, The flight time of each coarse point.
+	 * @Param @Output outPoints, The coarse points, truncated to end at the hit location if something is hit.
+	 * @Param @Output outHit, The first blocking hit along the arc.
+	 * @Param @Output outEndTime, Flight time the arc ends at.
+	 * @Param @Output outTraceCount, Number of scene queries made.
+	 * @Param occupancy, If not null the coarse segments it shows are empty aren't traced.
+	 * @Param @Output outSegmentsSkipped, If not null set to the number of coarse segments that weren't traced.
+	 * @Return true if anything was hit. */
+	static bool TraceArcRefined(UWorld* world, const FTeleportArcParams& params, int numSegments, int refineSteps, float clearanceRadius, ECollisionChannel channel, const FCollisionQueryParams& queryParams,
+		TArray<float>& outTimes, TArray<FVector>& outPoints, FHitResult& outHit, float& outEndTime, int& outTraceCount, const FTeleportOccupancyGrid* occupancy = nullptr, int* outSegmentsSkipped = nullptr);
+
+	/* Issue a line trace for every segment between consecutive points through the worlds async trace API.
+	 * NOTE: Every segment has to be issued as the first hit is not known until the results come back next frame.
+	 * @Param @Output outHandles, One trace handle per segment in order. */
+	static void TraceArcAsync(UWorld* world, const TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, TArray<FTraceHandle>& outHandles);
+
+	/* Find the first blocking hit from segment traces issued by TraceArcAsync on a previous frame.
+	 * @Param handles, The trace handles returned by TraceArcAsync.
+	 * @Param @Output points, The points the traces were issued for, truncated to end at the hit location if something was hit.
+	 * @Param @Output outHit, The first blocking hit along the arc.
+	 * @Param @Output outResolved, false if any of the results needed were no longer available.
+	 * @Return true if anything was hit. */
+	static bool ResolveArcAsync(UWorld* world, const TArray<FTraceHandle>& handles, TArray<FVector>& points, FHitResult& outHit, bool& outResolved);
+};
+
+/* Remembers the segments traced for the last teleport arc and their results so segments that have barely moved can re-use them. */
+struct NINETOFIVE_API FTeleportArcTraceCache
+{
+	TArray<FVector> segmentStarts; /* Start of each segment when it was last traced. */
+	TArray<FVector> segmentEnds; /* End of each segment when it was last traced. */
+	TArray<FHitResult> segmentHits; /* Result of each segment when it was last traced. */
+	int tracedSegments; /* Number of segments up to and including the first hit that have a valid result. */
+	int framesSinceFullTrace; /* Frames since every segment was last re-traced. */
+
+	FTeleportArcTraceCache()
+		: tracedSegments(0), framesSinceFullTrace(0)
+	{}
+
+	/* Forget all cached segments so the next arc is traced in full. */
+	void Reset();
+
+	/* Trace the arc like FTeleportArcSolver::TraceArc but re-use the cached result of any segment whose ends are within tolerance of where they were traced.
+	 * @Param tolerance, Distance either end of a segment can move before it is re-traced.
+	 * @Param refreshFrames, Number of frames after which every segment is re-traced to find anything that has moved into the arc.
+	 * @Param @Output outTraceCount, Number of scene queries made.
+	 * @Param @Output outTracesSaved, Number of segments that re-used a cached result instead of being traced.
+	 * @Param occupancy, If not null segments it shows are empty are cached as misses instead of being re-traced.
+	 * @Param @Output outSegmentsSkipped, If not null set to the number of segments the occupancy grid showed were empty.
+	 * @Return true if anything was hit. */
+	bool TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, float tolerance, int refreshFrames,
+		FHitResult& outHit, int& outTraceCount, int& outTracesSaved, const FTeleportOccupancyGrid* occupancy = nullptr, int* outSegmentsSkipped = nullptr);
+};
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportBlackoutQueue.h"
+#include "Player/VRMovement.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+
+TMap<TWeakObjectPtr<UWorld>, TUniquePtr<FTeleportBlackoutQueue>> FTeleportBlackoutQueue::worldQueues;
+
+FTeleportBlackoutQueue::FTeleportBlackoutQueue()
+{
+	nextHandle = 0;
+	nextJob = 0;
+}
+
+FTeleportBlackoutQueue* FTeleportBlackoutQueue::Get(UWorld* world, bool create)
+{
+	if (!world) return nullptr;
+	if (TUniquePtr<FTeleportBlackoutQueue>* queue = worldQueues.Find(world)) return queue->Get();
+	if (!create) return nullptr;
+
+	// Drop the queues of any worlds that have been destroyed before adding a new one.
+	for (auto queueIt = worldQueues.CreateIterator(); queueIt; ++queueIt)
+	{
+		if (!queueIt.Key().IsValid()) queueIt.RemoveCurrent();
+	}
+	return worldQueues.Add(world, MakeUnique<FTeleportBlackoutQueue>()).Get();
+}
+
+int32 FTeleportBlackoutQueue::Add(FName name, FTeleportBlackoutWork work, bool persistent)
+{
+	FJob& job = jobs.AddDefaulted_GetRef();
+	job.handle = nextHandle++;
+	job.name = name;
+	job.work = MoveTemp(work);
+	job.persistent = persistent;
+	return job.handle;
+}
+
+void FTeleportBlackoutQueue::Remove(int32 handle)
+{
+	int index = jobs.IndexOfByPredicate([handle](const FJob& job) { return job.handle == handle; });
+	if (index == INDEX_NONE) return;
+	jobs.RemoveAt(index);
+	if (nextJob > index) nextJob--;
+}
+
+double FTeleportBlackoutQueue::Drain(double budget, int& outJobsRun)
+{
+	outJobsRun = 0;
+	double startTime = FPlatformTime::Seconds();
+	double elapsed = 0.0;
+
+	// Give each job one go at most so persistent jobs that always have work don't keep the others waiting.
+	int jobsToRun = jobs.Num();
+	while (jobsToRun-- > 0 && jobs.Num() > 0 && elapsed < budget)
+	{
+		if (nextJob >= jobs.Num()) nextJob = 0;
+
+		// Jobs can add or remove others while running so find this one again by its handle afterwards.
+		int32 handle = jobs[nextJob].handle;
+		bool persistent = jobs[nextJob].persistent;
+		FName name = jobs[nextJob].name;
+		FTeleportBlackoutWork work = jobs[nextJob].work;
+		double jobStartTime = FPlatformTime::Seconds();
+		bool done = work(budget - elapsed);
+		outJobsRun++;
+		elapsed = FPlatformTime::Seconds() - startTime;
+		UE_LOG(LogVRMovement, Verbose, TEXT("FTeleportBlackoutQueue::Drain: Ran %s for %.2fms%s."), *name.ToString(), (FPlatformTime::Seconds() - jobStartTime) * 1000.0, done ? TEXT(", done") : TEXT(""));
+
+		int index = jobs.IndexOfByPredicate([handle](const FJob& job) { return job.handle == handle; });
+		if (index == INDEX_NONE) continue;
+		if (done && !persistent)
+		{
+			jobs.RemoveAt(index);
+			nextJob = index;
+		}
+		else nextJob = index + 1;
+	}
+	return elapsed;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+
+/* Declare classes used. */
+class UWorld;
+
+/* Work to run while the screen is faded out.
+ * @Param budget, Seconds the job can take before it should return.
+ * @Return true once the job has nothing left to do. */
+typedef TFunction<bool(double budget)> FTeleportBlackoutWork;
+
+/* Time sliced work that is only ran while the camera is faded out for a teleport so any dropped frames are never seen.
+ * NOTE: Jobs are ran round robin from where the last blackout stopped so a slow job can't starve the rest.
+ *       Only used on the game thread. */
+class NINETOFIVE_API FTeleportBlackoutQueue
+{
+private:
+
+	struct FJob
+	{
+		int32 handle;
+		FName name;
+		FTeleportBlackoutWork work;
+		bool persistent; /* Keep the job after it reports it is done so it runs again every blackout. */
+	};
+
+	TArray<FJob> jobs;
+	int32 nextHandle;
+	int nextJob; /* Job the next drain starts from. */
+
+	/* Every queue that has been created. */
+	static TMap<TWeakObjectPtr<UWorld>, TUniquePtr<FTeleportBlackoutQueue>> worldQueues;
+
+public:
+
+	/* Constructor. */
+	FTeleportBlackoutQueue();
+
+	/* Returns the blackout queue of a world.
+	 * @Param world, The world to get the queue of.
+	 * @Param create, Create the queue if the world doesn't have one yet.
+	 * @Return null if the world has no queue and create is false. */
+	static FTeleportBlackoutQueue* Get(UWorld* world, bool create);
+
+	/* Add a job to the queue.
+	 * @Param name, Name the job is logged with.
+	 * @Param work, The work to run, called with the time left in the blackouts budget.
+	 * @Param persistent, Keep the job after it returns true, otherwise it is removed once it's done.
+	 * @Return handle to remove the job with. */
+	int32 Add(FName name, FTeleportBlackoutWork work, bool persistent = false);
+
+	/* Remove a job before it is done. */
+	void Remove(int32 handle);
+
+	/* Run jobs until they are all done or the budget is spent, the job that runs past the budget is always finished first.
+	 * @Param budget, Seconds to spend running jobs.
+	 * @Param @Output outJobsRun, Number of jobs called.
+	 * @Return seconds spent running jobs. */
+	double Drain(double budget, int& outJobsRun);
+
+	/* Returns true if there are any jobs to run. */
+	bool HasWork() const { return jobs.Num() > 0; }
+};
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportNavCache.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavMesh/RecastNavMesh.h"
+#if WITH_RECAST
+#include "Detour/DetourNavMesh.h"
+#endif
+
+FTeleportNavCache::FTeleportNavCache()
+{
+	cellSize = 5.0f;
+	maxEntries = 4096;
+	hits = 0;
+	misses = 0;
+	lastExtent = FVector::ZeroVector;
+}
+
+ANavigationData* FTeleportNavCache::GetNavData(UNavigationSystemV1* navSystem, const FNavAgentProperties& props)
+{
+	// Only look the nav data up again if its been removed or the agent has changed.
+	if (!navData.IsValid() || !navDataProps.IsEquivalent(props))
+	{
+		ANavigationData* newNavData = navSystem ? navSystem->GetNavDataForProps(props) : nullptr;
+		if (newNavData != navData.Get()) Empty();
+		navData = newNavData;
+		navDataProps = props;
+	}
+	return navData.Get();
+}
+
+bool FTeleportNavCache::GetTile(const ANavigationData* currentNavData, const FVector& location, FIntPoint& outTile)
+{
+	const ARecastNavMesh* recastNavMesh = Cast<ARecastNavMesh>(currentNavData);
+	return recastNavMesh && recastNavMesh->GetNavMeshTileXY(location, outTile.X, outTile.Y);
+}
+
+uint64 FTeleportNavCache::GetTileSignature(const ANavigationData* currentNavData, const FIntPoint& tile)
+{
+	uint64 signature = 0;
+#if WITH_RECAST
+	// Detour bumps the salt in a tiles ref every time it is replaced so combining the refs of every layer changes on any rebuild.
+	const ARecastNavMesh* recastNavMesh = Cast<ARecastNavMesh>(currentNavData);
+	const dtNavMesh* detourMesh = recastNavMesh ? recastNavMesh->GetRecastMesh() : nullptr;
+	if (detourMesh)
+	{
+		const int maxLayers = 32;
+		const dtMeshTile* layers[maxLayers];
+		int numLayers = detourMesh->getTilesAt(tile.X, tile.Y, layers, maxLayers);
+		for (int i = 0; i < numLayers; i++)
+		{
+			signature = signature * 31 + (uint64)detourMesh->getTileRef(layers[i]);
+		}
+	}
+#endif
+	return signature;
+}
+
+bool FTeleportNavCache::ProjectPointProgressive(const ANavigationData* navData, const FVector& location, const FVector& minExtent, const FVector& maxExtent, FNavLocation& outLocation, int* outPolysTested, FSharedConstNavQueryFilter filter)
+{
+	if (outPolysTested) *outPolysTested = 0;
+	if (!navData) return false;
+
+	// Widen the search only when nothing is found, the last step is always the full extent.
+	FVector extent = minExtent.ComponentMin(maxExtent);
+	bool found = false;
+	while (true)
+	{
+#if WITH_RECAST
+		const ARecastNavMesh* recastNavMesh = Cast<ARecastNavMesh>(navData);
+		if (outPolysTested && recastNavMesh)
+		{
+			TArray<FNavPoly> polys;
+			recastNavMesh->GetPolysInBox(FBox(location - extent, location + extent), polys);
+			*outPolysTested += polys.Num();
+		}
+#endif
+		if (found)
+		{
+			// A closer poly can sit just outside the extent that hit along another axis, keep whichever of the two is closer.
+			FNavLocation widerLocation;
+			if (navData->ProjectPoint(location, widerLocation, extent, filter) && FVector::DistSquared(widerLocation.Location, location) < FVector::DistSquared(outLocation.Location, location)) outLocation = widerLocation;
+			return true;
+		}
+		found = navData->ProjectPoint(location, outLocation, extent, filter);
+		if (extent.Equals(maxExtent) || extent.IsNearlyZero()) return found;
+		extent = (extent * 2.0f).ComponentMin(maxExtent);
+	}
+}
+
+bool FTeleportNavCache::ProjectPoint(const ANavigationData* currentNavData, const FVector& location, const FVector& extent, const FVector& minExtent, int agent, FVector& outLocation, int* outPolysTested, FSharedConstNavQueryFilter filter)
+{
+	if (outPolysTested) *outPolysTested = 0;
+	if (!currentNavData) return false;
+
+	// Results found with a different extent can't be re-used.
+	if (!extent.Equals(lastExtent))
+	{
+		Empty();
+		lastExtent = extent;
+	}
+
+	// Look for a result from the same cell.
+	FTeleportNavCacheKey key(FIntVector(FMath::FloorToInt(location.X / cellSize), FMath::FloorToInt(location.Y / cellSize), FMath::FloorToInt(location.Z / cellSize)), agent);
+	if (const FTeleportNavCacheEntry* entry = entries.Find(key))
+	{
+		hits++;
+		outLocation = location + entry->offset;
+		return entry->onNavMesh;
+	}
+
+	// Otherwise query the nav-mesh and cache the result.
+	misses++;
+	FNavLocation navLocation;
+	bool onNavMesh = ProjectPointProgressive(currentNavData, location, minExtent, extent, navLocation, outPolysTested, filter);
+	if (onNavMesh) outLocation = navLocation.Location;
+
+	if (entries.Num() >= maxEntries) Empty();
+	FTeleportNavCacheEntry& newEntry = entries.Add(key);
+	newEntry.offset = onNavMesh ? navLocation.Location - location : FVector::ZeroVector;
+	newEntry.onNavMesh = onNavMesh;
+
+	// The result can come from, or would change with, any tile the search reached so file it under all of them.
+	FIntPoint minTile, maxTile;
+	if (GetTile(currentNavData, location - FVector(extent.X, extent.Y, 0.0f), minTile) && GetTile(currentNavData, location + FVector(extent.X, extent.Y, 0.0f), maxTile))
+	{
+		for (int y = FMath::Min(minTile.Y, maxTile.Y); y <= FMath::Max(minTile.Y, maxTile.Y); y++)
+		{
+			for (int x = FMath::Min(minTile.X, maxTile.X); x <= FMath::Max(minTile.X, maxTile.X); x++)
+			{
+				FIntPoint tileCoord(x, y);
+				FTile* tile = tiles.Find(tileCoord);
+				if (!tile)
+				{
+					tile = &tiles.Add(tileCoord);
+					tile->signature = GetTileSignature(currentNavData, tileCoord);
+				}
+				tile->keys.Add(key);
+			}
+		}
+	}
+	else untiledKeys.Add(key);
+	return onNavMesh;
+}
+
+void FTeleportNavCache::OnNavigationRebuilt(ANavigationData* rebuiltNavData)
+{
+	if (rebuiltNavData != navData.Get()) return;
+
+	// Without tiles there is no way to tell what changed so drop everything.
+	if (!Cast<ARecastNavMesh>(rebuiltNavData))
+	{
+		Empty();
+		return;
+	}
+
+	// Only drop the tiles that have actually been rebuilt, anything not found in a tile could have changed.
+	for (const FTeleportNavCacheKey& key : untiledKeys)
+	{
+		entries.Remove(key);
+	}
+	untiledKeys.Reset();
+
+	for (auto tileIt = tiles.CreateIterator(); tileIt; ++tileIt)
+	{
+		if (GetTileSignature(rebuiltNavData, tileIt.Key()) != tileIt.Value().signature)
+		{
+			for (const FTeleportNavCacheKey& key : tileIt.Value().keys)
+			{
+				entries.Remove(key);
+			}
+			tileIt.RemoveCurrent();
+		}
+	}
+}
+
+void FTeleportNavCache::Empty()
+{
+	entries.Reset();
+	tiles.Reset();
+	untiledKeys.Reset();
+}
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavQueryFilter.h"
+
+/* Declare classes used. */
+class UWorld;
+class ANavigationData;
+class UNavigationSystemV1;
+
+/* Key of a cached nav-mesh projection, the quantized query location and the nav agent it was projected for. */
+struct FTeleportNavCacheKey
+{
+	FIntVector cell;
+	int agent;
+
+	FTeleportNavCacheKey(const FIntVector& inCell, int inAgent)
+		: cell(inCell), agent(inAgent)
+	{}
+
+	bool operator==(const FTeleportNavCacheKey& other) const { return cell == other.cell && agent == other.agent; }
+	friend uint32 GetTypeHash(const FTeleportNavCacheKey& key) { return HashCombine(GetTypeHash(key.cell), ::GetTypeHash(key.agent)); }
+};
+
+/* Cached result of projecting a point onto the nav-mesh. */
+struct FTeleportNavCacheEntry
+{
+	FVector offset; /* Offset from the query location to the projected location. */
+	bool onNavMesh; /* Was a nav-mesh location found. */
+};
+
+/* Spatial hash of nav-mesh projection results so aiming at the same area costs a hash lookup instead of a Recast query.
+ * NOTE: Entries are grouped under every nav-mesh tile their search extent reached. When the navigation system reports a rebuild only
+ *       the tiles whose Detour tile refs have changed are dropped. */
+class NINETOFIVE_API FTeleportNavCache
+{
+public:
+
+	float cellSize; /* Size of the cells query locations are quantized into. */
+	int maxEntries; /* The cache is emptied if it grows past this many entries. */
+	int hits; /* Number of projections answered from the cache. */
+	int misses; /* Number of projections that had to query the nav-mesh. */
+
+private:
+
+	/* Cache keys found inside a nav-mesh tile and the tile refs they were found with. */
+	struct FTile
+	{
+		uint64 signature;
+		TArray<FTeleportNavCacheKey> keys;
+	};
+
+	TMap<FTeleportNavCacheKey, FTeleportNavCacheEntry> entries;
+	TMap<FIntPoint, FTile> tiles;
+	TArray<FTeleportNavCacheKey> untiledKeys; /* Keys found outside of any tile, dropped on every rebuild. */
+	TWeakObjectPtr<ANavigationData> navData; /* Nav data found for the last agent properties. */
+	FNavAgentProperties navDataProps;
+	FVector lastExtent; /* Search extent the cached entries were projected with. */
+
+	/* Returns the tile coordinates of location on the nav-mesh, false if the nav data isn't tiled. */
+	static bool GetTile(const ANavigationData* currentNavData, const FVector& location, FIntPoint& outTile);
+
+	/* Returns a value that changes whenever any layer of the given nav-mesh tile is rebuilt. */
+	static uint64 GetTileSignature(const ANavigationData* currentNavData, const FIntPoint& tile);
+
+public:
+
+	/* Constructor. */
+	FTeleportNavCache();
+
+	/* Returns the nav data for the given agent, only looking it up in the navigation system when the agent or nav data changes.
+	 * NOTE: Game thread only, the result can be passed to ProjectPoint on any thread. */
+	ANavigationData* GetNavData(UNavigationSystemV1* navSystem, const FNavAgentProperties& props);
+
+	/* Project a location onto the nav-mesh, using a cached result from the same cell if there is one.
+	 * NOTE: Touches no UObjects other than the nav data so it can be ran off the game thread while the nav-mesh isn't being changed.
+	 * @Param currentNavData, Nav data found with GetNavData.
+	 * @Param location, The location to project.
+	 * @Param extent, The search extent in each direction.
+	 * @Param minExtent, The first extent to search with on a cache miss, see ProjectPointProgressive.
+	 * @Param agent, Index of the nav agent in the project settings.
+	 * @Param @Output outLocation, The projected location if one was found.
+	 * @Param @Output outPolysTested, If not null set to the number of nav-mesh polys inside the searched extents, 0 on a cache hit.
+	 * @Param filter, Query filter to project with, the nav datas default filter if null.
+	 * @Return true if the location was projected onto the nav-mesh. */
+	bool ProjectPoint(const ANavigationData* currentNavData, const FVector& location, const FVector& extent, const FVector& minExtent, int agent, FVector& outLocation, int* outPolysTested = nullptr, FSharedConstNavQueryFilter filter = nullptr);
+
+	/* Project a location onto the nav-mesh starting with minExtent and doubling it up to maxExtent until a poly is found.
+	 * NOTE: After a hit the next wider extent is searched once more and the closer of the two kept. That catches nearly every
+	 * poly a single maxExtent search would prefer, but a flat or very uneven extent can still miss a closer poly further out.
+	 * @Param @Output outPolysTested, If not null set to the number of nav-mesh polys inside each extent searched. Counting them is a query of its own so only pass this when debugging.
+	 * @Return true if the location was projected onto the nav-mesh. */
+	static bool ProjectPointProgressive(const ANavigationData* navData, const FVector& location, const FVector& minExtent, const FVector& maxExtent, FNavLocation& outLocation, int* outPolysTested = nullptr, FSharedConstNavQueryFilter filter = nullptr);
+
+	/* Drop the cached results of any tile of rebuiltNavData that has changed since it was cached. */
+	void OnNavigationRebuilt(ANavigationData* rebuiltNavData);
+
+	/* Remove all cached results. */
+	void Empty();
+};
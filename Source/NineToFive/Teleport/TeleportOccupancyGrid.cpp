@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportOccupancyGrid.h"
+#include "Teleport/TeleportArcSolver.h"
+#include "Engine/World.h"
+#include "WorldCollision.h"
+#include "Components/PrimitiveComponent.h"
+#include "HAL/PlatformTime.h"
+
+FTeleportOccupancyGrid::FTeleportOccupancyGrid()
+{
+	origin = FVector::ZeroVector;
+	voxelSize = 50.0f;
+	size = FIntVector::ZeroValue;
+	bricks = FIntVector::ZeroValue;
+	nextBrick = 0;
+	built = false;
+}
+
+void FTeleportOccupancyGrid::BeginBuild(const FVector& center, const FVector& extent, float newVoxelSize)
+{
+	Empty();
+	if (newVoxelSize <= 0.0f) return;
+
+	// Round the area up to whole bricks.
+	voxelSize = newVoxelSize;
+	float brickWorldSize = voxelSize * brickSize;
+	bricks = FIntVector(FMath::Max(FMath::CeilToInt(extent.X * 2.0f / brickWorldSize), 1), FMath::Max(FMath::CeilToInt(extent.Y * 2.0f / brickWorldSize), 1), FMath::Max(FMath::CeilToInt(extent.Z * 2.0f / brickWorldSize), 1));
+	size = bricks * brickSize;
+	origin = center - FVector(size.X, size.Y, size.Z) * voxelSize * 0.5f;
+	occupied.Init(false, size.X * size.Y * size.Z);
+}
+
+bool FTeleportOccupancyGrid::ContinueBuild(UWorld* world, ECollisionChannel channel, const FCollisionQueryParams& queryParams, double budget, int& outOverlapTests)
+{
+	outOverlapTests = 0;
+	if (built) return true;
+	if (!world || !IsBuilding()) return false;
+
+	// Only static geometry is baked in, anything movable is checked when the arc is traced.
+	FCollisionQueryParams staticParams = queryParams;
+	staticParams.MobilityType = EQueryMobilityType::Static;
+
+	// Most of a play space is empty so test whole bricks first and only split the ones that hit something.
+	double startTime = FPlatformTime::Seconds();
+	int numBricks = bricks.X * bricks.Y * bricks.Z;
+	while (nextBrick < numBricks)
+	{
+		FIntVector brick(nextBrick % bricks.X, (nextBrick / bricks.X) % bricks.Y, nextBrick / (bricks.X * bricks.Y));
+		outOverlapTests += BuildCube(world, brick * brickSize, brickSize, channel, staticParams);
+		nextBrick++;
+		if (FPlatformTime::Seconds() - startTime >= budget) break;
+	}
+	built = nextBrick >= numBricks;
+	return built;
+}
+
+int FTeleportOccupancyGrid::Build(UWorld* world, const FVector& center, const FVector& extent, float newVoxelSize, ECollisionChannel channel, const FCollisionQueryParams& queryParams)
+{
+	int overlapTests = 0;
+	BeginBuild(center, extent, newVoxelSize);
+	ContinueBuild(world, channel, queryParams, MAX_dbl, overlapTests);
+	return overlapTests;
+}
+
+int FTeleportOccupancyGrid::BuildCube(UWorld* world, const FIntVector& cell, int cubeSize, ECollisionChannel channel, const FCollisionQueryParams& staticParams)
+{
+	// Grow each box slightly so geometry lying exactly on a voxel face marks both voxels.
+	float halfSize = cubeSize * voxelSize * 0.5f;
+	FVector cubeCenter = origin + FVector(cell.X, cell.Y, cell.Z) * voxelSize + FVector(halfSize);
+	if (!world->OverlapBlockingTestByChannel(cubeCenter, FQuat::Identity, channel, FCollisionShape::MakeBox(FVector(halfSize + 1.0f)), staticParams)) return 1;
+
+	if (cubeSize == 1)
+	{
+		occupied[GetIndex(cell.X, cell.Y, cell.Z)] = true;
+		return 1;
+	}
+
+	int overlapTests = 1;
+	int half = cubeSize / 2;
+	for (int i = 0; i < 8; i++)
+	{
+		overlapTests += BuildCube(world, cell + FIntVector((i & 1) * half, ((i >> 1) & 1) * half, ((i >> 2) & 1) * half), half, channel, staticParams);
+	}
+	return overlapTests;
+}
+
+bool FTeleportOccupancyGrid::SegmentHitsOccupied(const FVector& start, const FVector& end) const
+{
+	if (!built) return true;
+
+	// The grid is a box so the segment is inside it if both of its ends are, anything outside the grid has to be traced.
+	FVector a = (start - origin) / voxelSize;
+	FVector b = (end - origin) / voxelSize;
+	FVector gridMax(size.X, size.Y, size.Z);
+	if (a.X < 0.0f || a.Y < 0.0f || a.Z < 0.0f || a.X >= gridMax.X || a.Y >= gridMax.Y || a.Z >= gridMax.Z) return true;
+	if (b.X < 0.0f || b.Y < 0.0f || b.Z < 0.0f || b.X >= gridMax.X || b.Y >= gridMax.Y || b.Z >= gridMax.Z) return true;
+
+	// Step through every voxel the segment passes through one face crossing at a time.
+	FIntVector cell(FMath::FloorToInt(a.X), FMath::FloorToInt(a.Y), FMath::FloorToInt(a.Z));
+	FIntVector endCell(FMath::FloorToInt(b.X), FMath::FloorToInt(b.Y), FMath::FloorToInt(b.Z));
+	FVector dir = b - a;
+	int step[3];
+	float tMax[3], tDelta[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		step[axis] = dir[axis] > 0.0f ? 1 : -1;
+		if (FMath::IsNearlyZero(dir[axis]))
+		{
+			tMax[axis] = MAX_flt;
+			tDelta[axis] = MAX_flt;
+		}
+		else
+		{
+			float boundary = dir[axis] > 0.0f ? cell(axis) + 1.0f : (float)cell(axis);
+			tMax[axis] = (boundary - a[axis]) / dir[axis];
+			tDelta[axis] = FMath::Abs(1.0f / dir[axis]);
+		}
+	}
+
+	int maxSteps = FMath::Abs(endCell.X - cell.X) + FMath::Abs(endCell.Y - cell.Y) + FMath::Abs(endCell.Z - cell.Z);
+	for (int i = 0; i <= maxSteps; i++)
+	{
+		if (occupied[GetIndex(cell.X, cell.Y, cell.Z)]) return true;
+		if (cell == endCell) break;
+		int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+		cell(axis) = FMath::Clamp(cell(axis) + step[axis], 0, size(axis) - 1);
+		tMax[axis] += tDelta[axis];
+	}
+	return false;
+}
+
+int FTeleportOccupancyGrid::FindEmptySegments(UWorld* world, const TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, TArray<FBox, TInlineAllocator<8>>& outDynamicBounds, int& outTraceCount) const
+{
+	outDynamicBounds.Reset();
+	outTraceCount = 0;
+	if (!built || !world) return 0;
+
+	// Find the first segment that could hit static geometry, everything before it is empty as far as static geometry goes.
+	int numSegments = points.Num() - 1;
+	int firstOccupied = 0;
+	while (firstOccupied < numSegments && !SegmentHitsOccupied(points[firstOccupied], points[firstOccupied + 1]))
+	{
+		firstOccupied++;
+	}
+
+	// One overlap of the empty part finds any movable bodies in it, only the segments near them still need tracing.
+	if (firstOccupied > 0)
+	{
+		FBox emptyBounds(points.GetData(), firstOccupied + 1);
+		FCollisionQueryParams dynamicParams = queryParams;
+		dynamicParams.MobilityType = EQueryMobilityType::Dynamic;
+		TArray<FOverlapResult> overlaps;
+		world->OverlapMultiByChannel(overlaps, emptyBounds.GetCenter(), FQuat::Identity, channel, FCollisionShape::MakeBox(emptyBounds.GetExtent()), dynamicParams);
+		outTraceCount++;
+		for (const FOverlapResult& overlap : overlaps)
+		{
+			if (overlap.bBlockingHit && overlap.Component.IsValid()) outDynamicBounds.Add(overlap.Component->Bounds.GetBox());
+		}
+	}
+	return firstOccupied;
+}
+
+bool FTeleportOccupancyGrid::CanSkipSegment(const FVector& start, const FVector& end, const TArray<FBox, TInlineAllocator<8>>& dynamicBounds)
+{
+	FBox segmentBounds(ForceInit);
+	segmentBounds += start;
+	segmentBounds += end;
+	for (const FBox& bounds : dynamicBounds)
+	{
+		if (bounds.Intersect(segmentBounds)) return false;
+	}
+	return true;
+}
+
+bool FTeleportOccupancyGrid::TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, FHitResult& outHit, int& outTraceCount, int& outSegmentsSkipped) const
+{
+	outSegmentsSkipped = 0;
+	if (!built) return FTeleportArcSolver::TraceArc(world, points, channel, queryParams, outHit, outTraceCount);
+	outTraceCount = 0;
+	outHit.Init();
+	if (!world) return false;
+
+	TArray<FBox, TInlineAllocator<8>> dynamicBounds;
+	int emptySegments = FindEmptySegments(world, points, channel, queryParams, dynamicBounds, outTraceCount);
+	for (int i = 0; i < points.Num() - 1; i++)
+	{
+		if (i < emptySegments && CanSkipSegment(points[i], points[i + 1], dynamicBounds))
+		{
+			outSegmentsSkipped++;
+			continue;
+		}
+
+		outTraceCount++;
+		if (world->LineTraceSingleByChannel(outHit, points[i], points[i + 1], channel, queryParams))
+		{
+			// End the arc at the hit location.
+			points.SetNum(i + 2, false);
+			points[i + 1] = outHit.Location;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FTeleportOccupancyGrid::Empty()
+{
+	occupied.Empty();
+	size = FIntVector::ZeroValue;
+	bricks = FIntVector::ZeroValue;
+	nextBrick = 0;
+	built = false;
+}
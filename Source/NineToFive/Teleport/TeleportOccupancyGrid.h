@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+
+/* Declare classes used. */
+class UWorld;
+
+/* Coarse voxel grid of the static collision around the play space so the teleport arc can skip tracing segments that only pass through empty space.
+ * NOTE: Voxels are marked occupied if anything static blocking the channel overlaps them, so a segment that misses every occupied voxel can't hit static geometry.
+ *       Movable geometry is found with one overlap of the skipped part of the arc instead. Built and read on the game thread, read only while the teleport aim task runs.
+ *       The build can be spread over several frames a brick at a time, a grid being built is never read from. */
+class NINETOFIVE_API FTeleportOccupancyGrid
+{
+private:
+
+	FVector origin; /* World location of the grids min corner. */
+	float voxelSize;
+	FIntVector size; /* Number of voxels along each axis, always a multiple of brickSize. */
+	FIntVector bricks; /* Number of bricks along each axis. */
+	int nextBrick; /* Brick the build continues from. */
+	TBitArray<> occupied;
+	bool built;
+
+	/* Voxels per side of the boxes the build starts splitting from. */
+	static const int brickSize = 8;
+
+	/* Returns the index of a voxel in occupied. */
+	int GetIndex(int x, int y, int z) const { return (z * size.Y + y) * size.X + x; }
+
+	/* Mark every voxel of the cube at cell with the given number of voxels per side that static geometry overlaps, splitting it into eight until single voxels are reached.
+	 * @Return number of overlap tests made. */
+	int BuildCube(UWorld* world, const FIntVector& cell, int cubeSize, ECollisionChannel channel, const FCollisionQueryParams& staticParams);
+
+public:
+
+	/* Constructor. */
+	FTeleportOccupancyGrid();
+
+	/* Forget the grid and start a new one around center, nothing is tested until ContinueBuild is called.
+	 * @Param center, Center of the area to cover.
+	 * @Param extent, Half size of the area to cover.
+	 * @Param newVoxelSize, Size of each voxel. */
+	void BeginBuild(const FVector& center, const FVector& extent, float newVoxelSize);
+
+	/* Test the static collision of bricks until the grid is built or the budget is spent, at least one brick is always tested.
+	 * @Param world, World to test the collision of.
+	 * @Param channel, Channel the teleport arc is traced on.
+	 * @Param queryParams, Query params the teleport arc is traced with.
+	 * @Param budget, Seconds to spend testing bricks.
+	 * @Param @Output outOverlapTests, Number of overlap tests made.
+	 * @Return true once the grid is built. */
+	bool ContinueBuild(UWorld* world, ECollisionChannel channel, const FCollisionQueryParams& queryParams, double budget, int& outOverlapTests);
+
+	/* Build the whole grid from the static collision around center in one go.
+	 * @Return number of overlap tests made. */
+	int Build(UWorld* world, const FVector& center, const FVector& extent, float newVoxelSize, ECollisionChannel channel, const FCollisionQueryParams& queryParams);
+
+	/* Returns true if the segment passes through an occupied voxel or leaves the grid. */
+	bool SegmentHitsOccupied(const FVector& start, const FVector& end) const;
+
+	/* Find the segments at the start of the arc that only pass through empty voxels, and the bounds of any movable bodies one overlap of them finds.
+	 * @Param points, The arc points.
+	 * @Param @Output outDynamicBounds, Bounds of the movable bodies found, segments near them still have to be traced.
+	 * @Param @Output outTraceCount, Number of scene queries made.
+	 * @Return number of segments from the start of the arc that can't hit static geometry. */
+	int FindEmptySegments(UWorld* world, const TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, TArray<FBox, TInlineAllocator<8>>& outDynamicBounds, int& outTraceCount) const;
+
+	/* Returns true if the segment can be skipped, it is one of the empty segments and isn't near any of the movable bodies found with them. */
+	static bool CanSkipSegment(const FVector& start, const FVector& end, const TArray<FBox, TInlineAllocator<8>>& dynamicBounds);
+
+	/* Trace the arc like FTeleportArcSolver::TraceArc, but skip every segment before the first one that passes through an occupied voxel
+	 * unless it is near a movable body found by one overlap of their bounds.
+	 * @Param @Output outSegmentsSkipped, Number of segments that weren't traced.
+	 * @Return true if anything was hit. */
+	bool TraceArc(UWorld* world, TArray<FVector>& points, ECollisionChannel channel, const FCollisionQueryParams& queryParams, FHitResult& outHit, int& outTraceCount, int& outSegmentsSkipped) const;
+
+	/* Forget the grid so arcs are traced in full until it is built again. */
+	void Empty();
+
+	/* Has the grid been built. */
+	bool IsBuilt() const { return built; }
+
+	/* Has a build been started that isn't finished yet. */
+	bool IsBuilding() const { return !built && nextBrick < bricks.X * bricks.Y * bricks.Z; }
+};
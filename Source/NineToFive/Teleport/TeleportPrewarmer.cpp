@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportPrewarmer.h"
+#include "Engine/World.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/LevelStreamingVolume.h"
+#include "ContentStreaming.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+FTeleportPrewarmer::FTeleportPrewarmer()
+{
+	levelsRequested = 0;
+	location = FVector::ZeroVector;
+	active = false;
+	loadToken = MakeShared<int32>(0);
+}
+
+void FTeleportPrewarmer::Update(UWorld* world, const FVector& newLocation, float radius)
+{
+	if (!world) return;
+
+	// Texture streaming drops view slave locations after each update so keep adding the destination while its held.
+	IStreamingManager::Get().AddViewSlaveLocation(newLocation);
+
+	// Only request levels again once the destination has moved a fair way from where they were last requested.
+	if (active && FVector::DistSquared(newLocation, location) < FMath::Square(radius * 0.25f)) return;
+	location = newLocation;
+	active = true;
+	RequestStreamingLevels(world, radius);
+}
+
+void FTeleportPrewarmer::RequestStreamingLevels(UWorld* world, float radius)
+{
+	if (world->IsPlayInEditor()) return;
+
+	for (ULevelStreaming* streamingLevel : world->GetStreamingLevels())
+	{
+		if (!streamingLevel || streamingLevel->GetLoadedLevel() || streamingLevel->HasLoadRequestPending()) continue;
+
+		// Only levels driven by streaming volumes can be predicted from a location.
+		bool inVolume = false;
+		for (ALevelStreamingVolume* volume : streamingLevel->EditorStreamingVolumes)
+		{
+			if (volume && !volume->bDisabled && volume->EncompassesPoint(location, radius))
+			{
+				inVolume = true;
+				break;
+			}
+		}
+		if (!inVolume) continue;
+
+		// The level streaming finds the package already loaded when the volume requests it so only the level itself is left to add.
+		FName packageName = streamingLevel->GetLODPackageNameToLoad();
+		if (packageName == NAME_None || requestedPackages.Contains(packageName)) continue;
+		requestedPackages.Add(packageName);
+		levelsRequested++;
+
+		TWeakPtr<int32> token = loadToken;
+		LoadPackageAsync(packageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda([this, token](const FName& loadedName, UPackage* loadedPackage, EAsyncLoadingResult::Type result)
+		{
+			if (token.IsValid() && loadedPackage && result == EAsyncLoadingResult::Succeeded) loadedPackages.AddUnique(loadedPackage);
+		}));
+	}
+}
+
+void FTeleportPrewarmer::Reset()
+{
+	active = false;
+	levelsRequested = 0;
+	loadedPackages.Reset();
+	requestedPackages.Reset();
+	loadToken = MakeShared<int32>(0);
+}
+
+void FTeleportPrewarmer::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(loadedPackages);
+}
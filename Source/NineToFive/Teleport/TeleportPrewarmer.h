@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+
+/* Declare classes used. */
+class UWorld;
+class UPackage;
+
+/* Starts loading what the area around a teleport destination needs before the player gets there so the first frames after teleporting don't hitch.
+ * NOTE: Streaming levels are only preloaded outside of PIE as PIE levels are duplicated from their packages under a different name.
+ *       Only used on the game thread. */
+class NINETOFIVE_API FTeleportPrewarmer : public FGCObject
+{
+public:
+
+	int levelsRequested; /* Number of streaming level packages requested since the last reset. */
+
+private:
+
+	FVector location; /* Destination currently being warmed. */
+	bool active;
+	TArray<UPackage*> loadedPackages; /* Preloaded level packages kept loaded until the level streaming picks them up. */
+	TSet<FName> requestedPackages;
+	TSharedPtr<int32> loadToken; /* Replaced on every reset so loads requested for an old destination are dropped when they finish. */
+
+	/* Async load the packages of any unloaded streaming levels whose volumes contain location. */
+	void RequestStreamingLevels(UWorld* world, float radius);
+
+public:
+
+	/* Constructor. */
+	FTeleportPrewarmer();
+
+	/* Warm the area around newLocation, call every frame the destination is held.
+	 * @Param world, The world being teleported in.
+	 * @Param newLocation, The teleport destination.
+	 * @Param radius, Distance around the destination to load levels within. */
+	void Update(UWorld* world, const FVector& newLocation, float radius);
+
+	/* Stop warming and release any preloaded packages. */
+	void Reset();
+
+	/* Is a destination being warmed. */
+	bool IsActive() const { return active; }
+
+	/* Returns the destination being warmed. */
+	const FVector& GetLocation() const { return location; }
+
+	/* Keep the preloaded packages from being garbage collected. */
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+};
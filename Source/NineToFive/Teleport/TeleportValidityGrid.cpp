@@ -0,0 +1,300 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Teleport/TeleportValidityGrid.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+#include "Components/PrimitiveComponent.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Player/VRMovement.h"
+
+FTeleportValidityGrid::FTeleportValidityGrid()
+{
+	header = nullptr;
+	heights = nullptr;
+	cells = nullptr;
+}
+
+FTeleportValidityGrid::~FTeleportValidityGrid()
+{
+	// The region has to be unmapped before its file is closed.
+	mappedRegion.Reset();
+	mappedFile.Reset();
+}
+
+FString FTeleportValidityGrid::GetGridFilename(ULevel* level)
+{
+	// Use the levels package name without any PIE prefix so grids baked in PIE are found in game.
+	FString levelName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(level->GetOutermost()->GetName()));
+	return FPaths::ProjectContentDir() / TEXT("TeleportGrids") / levelName + TEXT(".tpg");
+}
+
+bool FTeleportValidityGrid::Bake(UWorld* world, ULevel* level, const FTeleportGridBakeSettings& settings)
+{
+	UNavigationSystemV1* navSystem = Cast<UNavigationSystemV1>(world->GetNavigationSystem());
+	ANavigationData* navData = navSystem ? navSystem->GetNavDataForProps(settings.navAgentProps) : nullptr;
+	if (!navData)
+	{
+		UE_LOG(LogVRMovement, Warning, TEXT("FTeleportValidityGrid::Bake: No nav-mesh found for the player agent, build paths before baking."));
+		return false;
+	}
+
+	// Cover the whole level with cells, an empty level still gets an empty grid so it isn't treated as un-baked.
+	FBox bounds(ForceInit);
+	for (AActor* actor : level->Actors)
+	{
+		if (actor && actor->IsLevelBoundsRelevant()) bounds += actor->GetComponentsBoundingBox();
+	}
+	FHeader newHeader;
+	FMemory::Memzero(newHeader);
+	newHeader.magic = fileMagic;
+	newHeader.version = fileVersion;
+	newHeader.cellSize = settings.cellSize;
+	if (bounds.IsValid)
+	{
+		newHeader.origin = FVector2D(bounds.Min);
+		newHeader.sizeX = FMath::CeilToInt((bounds.Max.X - bounds.Min.X) / settings.cellSize);
+		newHeader.sizeY = FMath::CeilToInt((bounds.Max.Y - bounds.Min.Y) / settings.cellSize);
+	}
+	int64 numCells = (int64)newHeader.sizeX * newHeader.sizeY;
+	if (numCells > 16 * 1024 * 1024)
+	{
+		UE_LOG(LogVRMovement, Warning, TEXT("FTeleportValidityGrid::Bake: %s would need %lld cells, use a larger cell size."), *level->GetOutermost()->GetName(), numCells);
+		return false;
+	}
+
+	TArray<float> newHeights;
+	TArray<uint8> newCells;
+	newHeights.SetNumZeroed(numCells);
+	newCells.SetNumZeroed(numCells);
+
+	FCollisionObjectQueryParams floorTypes(settings.teleportableTypes);
+	FCollisionObjectQueryParams allTypes(FCollisionObjectQueryParams::InitType::AllObjects);
+	FCollisionQueryParams overlapParams(SCENE_QUERY_STAT(TeleportGridBake), false);
+	overlapParams.AddIgnoredActors(settings.actorsToIgnore);
+	FVector searchExtent(settings.searchDistance);
+	FVector columnExtent(settings.cellSize * 0.5f, settings.cellSize * 0.5f, (bounds.Max.Z - bounds.Min.Z) * 0.5f + 1.0f);
+	int counts[3] = { 0, 0, 0 };
+
+	for (int y = 0; y < newHeader.sizeY; y++)
+	{
+		for (int x = 0; x < newHeader.sizeX; x++)
+		{
+			int64 index = (int64)y * newHeader.sizeX + x;
+			FVector center(newHeader.origin.X + (x + 0.5f) * settings.cellSize, newHeader.origin.Y + (y + 0.5f) * settings.cellSize, bounds.GetCenter().Z);
+			ETeleportGridCell state = ETeleportGridCell::Invalid;
+
+			// Anything movable in the column could change the result at runtime.
+			TArray<FOverlapResult> overlaps;
+			world->OverlapMultiByObjectType(overlaps, center, FQuat::Identity, allTypes, FCollisionShape::MakeBox(columnExtent), overlapParams);
+			for (const FOverlapResult& overlap : overlaps)
+			{
+				if (overlap.Component.IsValid() && overlap.Component->Mobility == EComponentMobility::Movable)
+				{
+					state = ETeleportGridCell::Dynamic;
+					break;
+				}
+			}
+
+			// Find every floor of this level in the column, skipping any that belong to other levels.
+			TArray<FHitResult> floors;
+			if (state != ETeleportGridCell::Dynamic)
+			{
+				FCollisionQueryParams floorParams(SCENE_QUERY_STAT(TeleportGridBake), false);
+				floorParams.AddIgnoredActors(settings.actorsToIgnore);
+				FVector traceStart(center.X, center.Y, bounds.Max.Z + 1.0f);
+				FVector traceEnd(center.X, center.Y, bounds.Min.Z - 1.0f);
+				FHitResult hit;
+				for (int i = 0; i < 32 && floors.Num() < 2 && world->LineTraceSingleByObjectType(hit, traceStart, traceEnd, floorTypes, floorParams))
+				{
+					if (hit.GetActor() && hit.GetActor()->GetLevel() == level) floors.Add(hit);
+					if (!hit.GetComponent()) break;
+					floorParams.AddIgnoredComponent(hit.GetComponent());
+				}
+			}
+
+			// The grid only stores a single height per cell so stacked floors are left to the live query.
+			if (floors.Num() > 1) state = ETeleportGridCell::Dynamic;
+			else if (floors.Num() == 1)
+			{
+				// Match the live query, project the floor onto the nav-mesh then find the floor under the nav-mesh.
+				FNavLocation navLocation;
+				FVector floorLocation = floors[0].Location + floors[0].ImpactNormal;
+				if (navData->ProjectPoint(floorLocation, navLocation, searchExtent))
+				{
+					// If the nav-mesh is found outside of the cell this is near an edge and the live query will snap to it.
+					if (FVector::DistSquared2D(navLocation.Location, center) > FMath::Square(settings.cellSize * 0.5f)) state = ETeleportGridCell::Dynamic;
+					else
+					{
+						FHitResult heightHit;
+						FCollisionQueryParams heightParams(SCENE_QUERY_STAT(TeleportGridBake), false);
+						heightParams.AddIgnoredActors(settings.actorsToIgnore);
+						bool floorFound = world->LineTraceSingleByObjectType(heightHit, navLocation.Location, navLocation.Location - FVector(0.0f, 0.0f, 10.0f), floorTypes, heightParams);
+						newHeights[index] = floorFound ? heightHit.Location.Z : navLocation.Location.Z;
+						state = ETeleportGridCell::Valid;
+					}
+				}
+			}
+
+			newCells[index] = (uint8)state;
+			counts[(int)state]++;
+		}
+	}
+
+	// Write the header, heights then cells as one block that can be mapped straight back in.
+	TArray<uint8> fileData;
+	fileData.Append((const uint8*)&newHeader, sizeof(FHeader));
+	fileData.Append((const uint8*)newHeights.GetData(), newHeights.Num() * sizeof(float));
+	fileData.Append(newCells);
+	FString filename = GetGridFilename(level);
+	if (!FFileHelper::SaveArrayToFile(fileData, *filename))
+	{
+		UE_LOG(LogVRMovement, Warning, TEXT("FTeleportValidityGrid::Bake: Failed to write %s."), *filename);
+		return false;
+	}
+
+	UE_LOG(LogVRMovement, Log, TEXT("FTeleportValidityGrid::Bake: Saved %s, %dx%d cells, %d valid, %d invalid, %d dynamic."),
+		*filename, newHeader.sizeX, newHeader.sizeY, counts[(int)ETeleportGridCell::Valid], counts[(int)ETeleportGridCell::Invalid], counts[(int)ETeleportGridCell::Dynamic]);
+	return true;
+}
+
+bool FTeleportValidityGrid::SetData(const uint8* data, int64 size)
+{
+	if (!data || size < (int64)sizeof(FHeader)) return false;
+	const FHeader* newHeader = (const FHeader*)data;
+	if (newHeader->magic != fileMagic || newHeader->version != fileVersion || newHeader->sizeX < 0 || newHeader->sizeY < 0) return false;
+
+	int64 numCells = (int64)newHeader->sizeX * newHeader->sizeY;
+	if (size < (int64)sizeof(FHeader) + numCells * (int64)(sizeof(float) + sizeof(uint8))) return false;
+
+	header = newHeader;
+	heights = (const float*)(data + sizeof(FHeader));
+	cells = data + sizeof(FHeader) + numCells * sizeof(float);
+	return true;
+}
+
+bool FTeleportValidityGrid::Load(const FString& filename)
+{
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!platformFile.FileExists(*filename)) return false;
+
+	// Map the file so only the pages that are looked up are ever read.
+	mappedFile.Reset(platformFile.OpenMapped(*filename));
+	if (mappedFile.IsValid())
+	{
+		mappedRegion.Reset(mappedFile->MapRegion());
+		if (mappedRegion.IsValid()) return SetData(mappedRegion->GetMappedPtr(), mappedRegion->GetMappedSize());
+	}
+
+	// Otherwise read the whole file in.
+	mappedRegion.Reset();
+	mappedFile.Reset();
+	if (!FFileHelper::LoadFileToArray(loadedData, *filename)) return false;
+	return SetData(loadedData.GetData(), loadedData.Num());
+}
+
+bool FTeleportValidityGrid::Contains(const FVector& location) const
+{
+	if (!header) return false;
+	float localX = (location.X - header->origin.X) / header->cellSize;
+	float localY = (location.Y - header->origin.Y) / header->cellSize;
+	return localX >= 0.0f && localY >= 0.0f && localX < header->sizeX && localY < header->sizeY;
+}
+
+ETeleportGridCell FTeleportValidityGrid::GetCell(const FVector& location, float& outHeight) const
+{
+	if (!Contains(location)) return ETeleportGridCell::Invalid;
+	int x = FMath::FloorToInt((location.X - header->origin.X) / header->cellSize);
+	int y = FMath::FloorToInt((location.Y - header->origin.Y) / header->cellSize);
+	int64 index = (int64)y * header->sizeX + x;
+	outHeight = heights[index];
+	return (ETeleportGridCell)cells[index];
+}
+
+FTeleportValidityGrids::FTeleportValidityGrids()
+{
+	hits = 0;
+	fallbacks = 0;
+	allLevelsBaked = false;
+}
+
+bool FTeleportValidityGrids::UpdateLevels(UWorld* world)
+{
+	// Drop the grids of levels that have been streamed out or hidden.
+	for (auto gridIt = levelGrids.CreateIterator(); gridIt; ++gridIt)
+	{
+		ULevel* level = gridIt.Key().Get();
+		if (!level || !level->bIsVisible) gridIt.RemoveCurrent();
+	}
+
+	// Load the grid of any level that has become visible, remembering levels without one so the file is only looked for once.
+	bool allBaked = true;
+	for (ULevel* level : world->GetLevels())
+	{
+		if (!level || !level->bIsVisible) continue;
+		TSharedPtr<FTeleportValidityGrid>* grid = levelGrids.Find(level);
+		if (!grid)
+		{
+			TSharedPtr<FTeleportValidityGrid> newGrid = MakeShared<FTeleportValidityGrid>();
+			if (!newGrid->Load(FTeleportValidityGrid::GetGridFilename(level))) newGrid.Reset();
+			grid = &levelGrids.Add(level, newGrid);
+		}
+		if (!grid->IsValid()) allBaked = false;
+	}
+	allLevelsBaked = allBaked;
+	return allBaked;
+}
+
+ETeleportGridResult FTeleportValidityGrids::Lookup(UWorld* world, const FVector& location, float heightTolerance, float& outHeight)
+{
+	// Floors of a level without a grid could be anywhere so only trust the grids when every visible level has one.
+	if (world) UpdateLevels(world);
+	if (!allLevelsBaked)
+	{
+		fallbacks++;
+		return ETeleportGridResult::Unknown;
+	}
+
+	// Use the valid floor closest to the hit from any level, unless a level needs the live query here.
+	bool covered = false;
+	bool found = false;
+	float closest = heightTolerance;
+	for (const auto& levelGrid : levelGrids)
+	{
+		if (!levelGrid.Value->Contains(location)) continue;
+		covered = true;
+
+		float height = 0.0f;
+		ETeleportGridCell cell = levelGrid.Value->GetCell(location, height);
+		if (cell == ETeleportGridCell::Dynamic)
+		{
+			fallbacks++;
+			return ETeleportGridResult::Unknown;
+		}
+		if (cell == ETeleportGridCell::Valid && FMath::Abs(location.Z - height) <= closest)
+		{
+			closest = FMath::Abs(location.Z - height);
+			outHeight = height;
+			found = true;
+		}
+	}
+
+	if (!covered)
+	{
+		fallbacks++;
+		return ETeleportGridResult::Unknown;
+	}
+	hits++;
+	return found ? ETeleportGridResult::Valid : ETeleportGridResult::Invalid;
+}
+
+void FTeleportValidityGrids::Empty()
+{
+	levelGrids.Reset();
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "Engine/EngineTypes.h"
+
+/* Declare classes used. */
+class UWorld;
+class ULevel;
+class AActor;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/* Baked state of a single teleport grid cell. */
+enum class ETeleportGridCell : uint8
+{
+	Invalid, /* Nothing teleportable in this cell. */
+	Valid, /* A single teleportable surface on the nav-mesh, its height is stored in the grid. */
+	Dynamic, /* Movable objects, more than one floor or the edge of the nav-mesh, always use the live query. */
+};
+
+/* Result of looking a location up in the baked teleport grids. */
+enum class ETeleportGridResult : uint8
+{
+	Unknown, /* Not covered by a loaded grid or in a dynamic cell, the live query has to be used. */
+	Valid,
+	Invalid,
+};
+
+/* Settings used when baking a teleport grid. */
+struct FTeleportGridBakeSettings
+{
+	float cellSize; /* Size of each cell in the grid. */
+	float searchDistance; /* Nav-mesh search extent used by the live teleport query. */
+	TArray<TEnumAsByte<EObjectTypeQuery>> teleportableTypes; /* Floor types that can be teleported onto. */
+	FNavAgentProperties navAgentProps; /* Nav agent to project cells onto the nav-mesh for. */
+	TArray<AActor*> actorsToIgnore; /* Actors that shouldn't mark cells as dynamic, for example the player. */
+};
+
+/* 2.5D grid of valid teleport heights baked for a single level and memory mapped from disk at runtime.
+ * NOTE: The file is a fixed header followed by a float height and then a byte state per cell, so it is used in place without any parsing. */
+class NINETOFIVE_API FTeleportValidityGrid
+{
+private:
+
+	/* Header at the start of a baked grid file. */
+	struct FHeader
+	{
+		uint32 magic;
+		uint32 version;
+		FVector2D origin; /* World XY of the minimum corner of the first cell. */
+		float cellSize;
+		int32 sizeX;
+		int32 sizeY;
+		uint32 reserved;
+	};
+
+	static const uint32 fileMagic = 0x44475054; /* "TPGD". */
+	static const uint32 fileVersion = 1;
+
+	TUniquePtr<IMappedFileHandle> mappedFile;
+	TUniquePtr<IMappedFileRegion> mappedRegion;
+	TArray<uint8> loadedData; /* Used instead of the mapped region on platforms that can't memory map files. */
+	const FHeader* header;
+	const float* heights;
+	const uint8* cells;
+
+	/* Point the header, heights and cells at data, returns false if data isn't a valid grid. */
+	bool SetData(const uint8* data, int64 size);
+
+public:
+
+	/* Constructor. */
+	FTeleportValidityGrid();
+
+	/* Destructor. */
+	~FTeleportValidityGrid();
+
+	/* Returns the file a levels grid is baked to and loaded from. */
+	static FString GetGridFilename(ULevel* level);
+
+	/* Sample the nav-mesh and floor of level into a grid and save it to GetGridFilename.
+	 * @Param world, The world the level is loaded in.
+	 * @Param level, The level to bake, only its own floors are used.
+	 * @Param settings, The cell size, floor types and nav agent to bake with.
+	 * @Return true if the grid was saved. */
+	static bool Bake(UWorld* world, ULevel* level, const FTeleportGridBakeSettings& settings);
+
+	/* Memory map a baked grid file, returns false if it doesn't exist or is out of date. */
+	bool Load(const FString& filename);
+
+	/* Look up the cell containing location.
+	 * @Param location, World location to look up.
+	 * @Param @Output outHeight, The baked height of the cell if it is valid.
+	 * @Return the cells state, Invalid if location is outside of the grid. */
+	ETeleportGridCell GetCell(const FVector& location, float& outHeight) const;
+
+	/* Returns true if location is inside of the grid on the XY plane. */
+	bool Contains(const FVector& location) const;
+};
+
+/* The teleport grids of every visible level in a world, loaded the first time a location is looked up after a level becomes visible. */
+class NINETOFIVE_API FTeleportValidityGrids
+{
+private:
+
+	/* Grid of each visible level, null if the level has no baked grid. */
+	TMap<TWeakObjectPtr<ULevel>, TSharedPtr<FTeleportValidityGrid>> levelGrids;
+	bool allLevelsBaked; /* Did every visible level have a baked grid last UpdateLevels. */
+
+public:
+
+	int hits; /* Number of lookups answered by a grid. */
+	int fallbacks; /* Number of lookups that had to use the live query. */
+
+	/* Constructor. */
+	FTeleportValidityGrids();
+
+	/* Load the grids of newly visible levels and drop the grids of any that have been unloaded or hidden. NOTE: Game thread only.
+	 * @Return false if any visible level doesn't have a baked grid. */
+	bool UpdateLevels(UWorld* world);
+
+	/* Find if location is a valid teleport location from the baked grids.
+	 * @Param world, The world to use the visible levels of, null to use the levels found by the last UpdateLevels from off the game thread.
+	 * @Param location, The teleport arcs hit location.
+	 * @Param heightTolerance, How far the baked floor height can be from location for it to be used.
+	 * @Param @Output outHeight, The baked floor height if the result is valid.
+	 * @Return Unknown if the live nav-mesh query should be used instead. */
+	ETeleportGridResult Lookup(UWorld* world, const FVector& location, float heightTolerance, float& outHeight);
+
+	/* Unmap all loaded grids. */
+	void Empty();
+};
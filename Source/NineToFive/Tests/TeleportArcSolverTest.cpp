@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "Teleport/TeleportArcSolver.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeleportArcRefinedTest, "NineToFive.Teleport.ArcRefinedMatchesDense", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/* Spawn an actor with a blocking box as its root. */
+static void SpawnBlockingBox(UWorld* world, const FVector& location, const FVector& extent)
+{
+	AActor* actor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform(location));
+	UBoxComponent* box = NewObject<UBoxComponent>(actor);
+	box->SetBoxExtent(extent);
+	box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	actor->SetRootComponent(box);
+	box->RegisterComponent();
+	box->SetWorldLocation(location);
+}
+
+bool FTeleportArcRefinedTest::RunTest(const FString& Parameters)
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false);
+	if (!TestNotNull(TEXT("World"), world)) return false;
+
+	// A floor with its top at 0 and a wall tall enough that no arc grazes its top.
+	SpawnBlockingBox(world, FVector(0.0f, 0.0f, -10.0f), FVector(5000.0f, 5000.0f, 10.0f));
+	SpawnBlockingBox(world, FVector(600.0f, 0.0f, 200.0f), FVector(10.0f, 5000.0f, 400.0f));
+
+	// Defaults used by the movement actor.
+	const int coarseSegments = 8;
+	const int refineSteps = 6;
+	const float clearanceRadius = 2.0f;
+	const float tolerance = clearanceRadius * 2.0f + 1.0f;
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(TeleportArcTest), false);
+
+	// Launch angles that land on the floor before the wall, on the floor and on the wall.
+	const float pitches[] = { -30.0f, -10.0f, 0.0f, 5.0f, 30.0f, 45.0f, 60.0f };
+	for (float pitch : pitches)
+	{
+		FTeleportArcParams arcParams;
+		arcParams.start = FVector(0.0f, 0.0f, 150.0f);
+		arcParams.velocity = FRotator(pitch, 0.0f, 0.0f).Vector() * 1000.0f;
+		arcParams.gravityZ = -1600.0f;
+		arcParams.maxSimTime = 2.0f;
+
+		// Dense path with 0.01 second segments.
+		TArray<float> denseTimes;
+		TArray<FVector> densePoints;
+		FHitResult denseHit;
+		int denseTraces = 0;
+		FTeleportArcSolver::SampleUniform(arcParams, 200, denseTimes, densePoints);
+		bool denseLanded = FTeleportArcSolver::TraceArc(world, densePoints, ECC_WorldStatic, queryParams, denseHit, denseTraces);
+
+		TArray<float> refinedTimes;
+		TArray<FVector> refinedPoints;
+		FHitResult refinedHit;
+		float refinedEndTime = 0.0f;
+		int refinedTraces = 0;
+		bool refinedLanded = FTeleportArcSolver::TraceArcRefined(world, arcParams, coarseSegments, refineSteps, clearanceRadius, ECC_WorldStatic, queryParams,
+			refinedTimes, refinedPoints, refinedHit, refinedEndTime, refinedTraces);
+
+		TestTrue(FString::Printf(TEXT("Dense arc at %.0f degrees lands"), pitch), denseLanded);
+		TestEqual(FString::Printf(TEXT("Refined arc at %.0f degrees lands like the dense arc"), pitch), refinedLanded, denseLanded);
+		if (denseLanded && refinedLanded)
+		{
+			float distance = FVector::Dist(denseHit.Location, refinedHit.Location);
+			TestTrue(FString::Printf(TEXT("Refined arc at %.0f degrees landed %.2fcm from the dense arc, more than %.2fcm"), pitch, distance, tolerance), distance <= tolerance);
+		}
+	}
+
+	world->DestroyWorld(false);
+	return true;
+}
+
+#endif